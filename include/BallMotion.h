@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <glm/glm.hpp>
+#include "BallState.h"
+#include "TableParameters.h"
+
+// Fase do movimento de uma bola sobre o pano
+enum BallPhase { BALL_STOPPED, BALL_ROLLING, BALL_SLIDING };
+
+// Movimento de uma bola no plano da mesa (X, Z) em forma fechada, pelo
+// modelo clássico de três fases:
+//
+//  - deslizando: o ponto de contato escorrega com velocidade u = v - s, e o
+//    atrito cinético (coeficiente mu_s) age contra u. A direção de u não
+//    muda, então v perde mu_s g por segundo nessa direção e s ganha
+//    5/2 mu_s g, até u zerar em t_roll = 2 |u0| / (7 mu_s g);
+//  - rolando: s = v, e a resistência ao rolamento (coeficiente mu_r) freia a
+//    bola a mu_r g até ela parar em t_stop;
+//  - parada.
+//
+// s é a velocidade, devida ao giro, da superfície da bola no ponto de
+// contato com o pano (BallState::spinVelocity). Em cada fase a posição é um
+// polinômio de grau 2 no tempo, então o estado em qualquer instante sai
+// direto, sem integração e sem depender do tamanho do passo.
+struct BallTrajectory
+{
+    glm::vec2 p0, v0, s0;  // Estado no início (t = 0)
+    glm::vec2 slide_accel; // Aceleração de v enquanto desliza (-mu_s g na direção de u)
+    glm::vec2 p1, v1;      // Estado no início do rolamento (t = t_roll)
+    glm::vec2 roll_accel;  // Aceleração enquanto rola (-mu_r g na direção de v1)
+    float t_roll;          // Fim do deslize (0 se a bola já começa rolando)
+    float t_stop;          // Instante em que a bola para (0 se já está parada)
+
+    BallTrajectory();
+    BallTrajectory(const glm::vec2& position, const glm::vec2& velocity, const glm::vec2& spin_velocity,
+                   const TableParameters& table);
+
+    BallPhase phase(float t) const;
+    glm::vec2 position(float t) const;
+    glm::vec2 velocity(float t) const;
+    glm::vec2 spinVelocity(float t) const;
+    glm::vec2 acceleration(float t) const;
+
+    // Integral de spinVelocity de 0 a t: o quanto a superfície da bola
+    // "rolou" no período. O giro da bola é (S.y, 0, -S.x) / raio.
+    glm::vec2 spinTravel(float t) const;
+
+    // Próximo instante depois de t em que a fase muda (t_roll ou t_stop), ou
+    // infinito se a bola já parou
+    float nextPhaseChange(float t) const;
+};
+
+// Trajetória da bola i a partir do estado atual, ignorando colisões. Serve
+// para consultas baratas como a linha de mira.
+BallTrajectory TrajetoriaDaBola(const BallState& balls, size_t i, const TableParameters& table);
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Alocador para std::vector que alinha o início do vetor em ALIGNMENT bytes,
+// permitindo leituras vetoriais (SSE/AVX) alinhadas nos arrays das bolas.
+template <typename T, size_t ALIGNMENT>
+struct AlignedAllocator
+{
+    typedef T value_type;
+
+    template <typename U>
+    struct rebind { typedef AlignedAllocator<U, ALIGNMENT> other; };
+
+    AlignedAllocator() {}
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, ALIGNMENT>&) {}
+
+    T* allocate(size_t n)
+    {
+        void* ptr = NULL;
+#if defined(_WIN32)
+        ptr = _aligned_malloc(n * sizeof(T), ALIGNMENT);
+#else
+        if (posix_memalign(&ptr, ALIGNMENT, n * sizeof(T)) != 0)
+            ptr = NULL;
+#endif
+        if (!ptr)
+            throw std::bad_alloc();
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, size_t)
+    {
+#if defined(_WIN32)
+        _aligned_free(ptr);
+#else
+        free(ptr);
+#endif
+    }
+};
+
+template <typename T, typename U, size_t A>
+bool operator==(const AlignedAllocator<T, A>&, const AlignedAllocator<U, A>&) { return true; }
+template <typename T, typename U, size_t A>
+bool operator!=(const AlignedAllocator<T, A>&, const AlignedAllocator<U, A>&) { return false; }
+
+// Alinhamento de uma linha de cache (cobre registradores AVX de 32 bytes)
+const size_t BALL_STATE_ALIGNMENT = 64;
+
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T, BALL_STATE_ALIGNMENT> >;
+
+// Estado das bolas no formato "structure of arrays" (SoA). Os arrays quentes,
+// lidos a cada passo da física, ficam contíguos e alinhados; os dados usados
+// só de vez em quando (orientação, número da bola) ficam em arrays separados
+// para não ocupar as mesmas linhas de cache. A bola i é a i-ésima posição de
+// todos os arrays.
+struct BallState
+{
+    // Dados quentes
+    AlignedVector<float>   px, py, pz; // Posição do centro da bola
+    AlignedVector<float>   vx, vy, vz; // Velocidade linear
+    AlignedVector<float>   wx, wz;     // Velocidade angular nos eixos horizontais (giro de rolamento, efeito)
+    AlignedVector<float>   radius;
+    AlignedVector<uint8_t> active;     // 0 se a bola caiu na caçapa
+    AlignedVector<uint8_t> asleep;     // 1 se a bola está dormindo (parada, fora da simulação)
+
+    // Dados frios. A orientação é atualizada de forma preguiçosa: a física
+    // só soma o giro de cada subpasso em rotation (eixo * ângulo, sem
+    // trigonometria), e o giro vira quatérnio em resolveOrientation(), uma
+    // vez por quadro desenhado ou quando alguém precisa da orientação.
+    std::vector<glm::quat> orientation; // Orientação (rolamento) até o último resolveOrientation()
+    std::vector<glm::vec3> rotation;    // Giro acumulado desde então, ainda não aplicado
+    std::vector<int>       number;      // Número da bola (0 é a bola branca)
+    std::vector<uint16_t>  still_steps; // Passos seguidos que a bola passou parada
+
+    size_t size() const { return px.size(); }
+    bool empty() const { return px.empty(); }
+
+    // Adiciona uma bola parada e ativa. Retorna o índice da nova bola.
+    size_t add(int ball_number, const glm::vec3& position, float ball_radius)
+    {
+        px.push_back(position.x); py.push_back(position.y); pz.push_back(position.z);
+        vx.push_back(0.0f);       vy.push_back(0.0f);       vz.push_back(0.0f);
+        wx.push_back(0.0f);       wz.push_back(0.0f);
+        radius.push_back(ball_radius);
+        active.push_back(1);
+        asleep.push_back(0);
+        orientation.push_back(glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+        rotation.push_back(glm::vec3(0.0f));
+        number.push_back(ball_number);
+        still_steps.push_back(0);
+        return px.size() - 1;
+    }
+
+    void reserve(size_t n)
+    {
+        px.reserve(n); py.reserve(n); pz.reserve(n);
+        vx.reserve(n); vy.reserve(n); vz.reserve(n);
+        wx.reserve(n); wz.reserve(n);
+        radius.reserve(n);
+        active.reserve(n);
+        asleep.reserve(n);
+        orientation.reserve(n);
+        rotation.reserve(n);
+        number.reserve(n);
+        still_steps.reserve(n);
+    }
+
+    void clear()
+    {
+        px.clear(); py.clear(); pz.clear();
+        vx.clear(); vy.clear(); vz.clear();
+        wx.clear(); wz.clear();
+        radius.clear();
+        active.clear();
+        asleep.clear();
+        orientation.clear();
+        rotation.clear();
+        number.clear();
+        still_steps.clear();
+    }
+
+    // Bytes alocados pelos arrays (capacidade, não só o tamanho)
+    size_t memoryUsage() const
+    {
+        return (px.capacity() + py.capacity() + pz.capacity() +
+                vx.capacity() + vy.capacity() + vz.capacity() +
+                wx.capacity() + wz.capacity() + radius.capacity()) * sizeof(float) +
+               (active.capacity() + asleep.capacity()) * sizeof(uint8_t) +
+               orientation.capacity() * sizeof(glm::quat) +
+               rotation.capacity() * sizeof(glm::vec3) +
+               number.capacity() * sizeof(int) +
+               still_steps.capacity() * sizeof(uint16_t);
+    }
+
+    glm::vec3 position(size_t i) const { return glm::vec3(px[i], py[i], pz[i]); }
+    glm::vec3 velocity(size_t i) const { return glm::vec3(vx[i], vy[i], vz[i]); }
+
+    // Velocidade (X, Z) da superfície da bola no ponto de contato com o
+    // pano, devida ao giro: raio * (w x up). Rolando sem deslizar, é igual à
+    // velocidade linear.
+    glm::vec2 spinVelocity(size_t i) const { return radius[i] * glm::vec2(-wz[i], wx[i]); }
+    void setSpinVelocity(size_t i, const glm::vec2& s) { wx[i] = s.y / radius[i]; wz[i] = -s.x / radius[i]; wake(i); }
+
+    // Orientação atual da bola i, com o giro pendente, sem alterar o estado
+    glm::quat currentOrientation(size_t i) const
+    {
+        return glm::normalize(QuaternioDoGiro(rotation[i]) * orientation[i]);
+    }
+
+    // Aplica o giro pendente da bola i em orientation e zera rotation
+    void resolveOrientation(size_t i)
+    {
+        if (rotation[i] == glm::vec3(0.0f))
+            return;
+        orientation[i] = currentOrientation(i);
+        rotation[i] = glm::vec3(0.0f);
+    }
+
+    // Quatérnio do giro r = eixo * ângulo. Somar giros antes de converter é
+    // exato enquanto o eixo não muda (bola rolando em linha reta) e uma boa
+    // aproximação entre quadros, quando a direção muda pouco.
+    static glm::quat QuaternioDoGiro(const glm::vec3& r)
+    {
+        float angle = glm::length(r);
+        if (angle < 1e-8f)
+            return glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+        return glm::angleAxis(angle, r / angle);
+    }
+
+    // Acorda a bola i, que volta a ser simulada no próximo passo. Quem altera
+    // posição ou velocidade direto nos arrays deve chamar wake() depois;
+    // setPosition() e setVelocity() já acordam a bola.
+    void wake(size_t i) { asleep[i] = 0; still_steps[i] = 0; }
+
+    void setPosition(size_t i, const glm::vec3& p) { px[i] = p.x; py[i] = p.y; pz[i] = p.z; wake(i); }
+    void setVelocity(size_t i, const glm::vec3& v) { vx[i] = v.x; vy[i] = v.y; vz[i] = v.z; wake(i); }
+};
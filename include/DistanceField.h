@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "game_objects.h"
+
+// Campo de distância pré-calculado para as tabelas e entradas das caçapas.
+// A região em volta dos segmentos é dividida em células quadradas; nos
+// vértices das células guardamos a distância (no plano XZ) até o segmento
+// mais próximo, e em cada célula a lista dos segmentos que podem encostar
+// em uma bola dentro dela. Uma consulta bola-tabela vira uma interpolação
+// bilinear; só quando o campo indica contato possível é que a bola é testada
+// contra os segmentos candidatos da célula, com o teste exato de sempre.
+//
+// Os segmentos não formam um contorno fechado (as caçapas ficam abertas),
+// então o campo guarda a distância sem sinal. A normal do contato sai do
+// teste exato, por isso não há um campo de normais separado.
+class SegmentDistanceField
+{
+public:
+    SegmentDistanceField();
+
+    // Monta o campo para os segmentos dados. Os índices dos candidatos seguem
+    // a ordem pocketSegments, depois tableSegments. max_ball_radius é o maior
+    // raio de bola para o qual as listas de candidatos são válidas.
+    void build(const std::vector<BoundingSegment>& pocketSegments,
+               const std::vector<BoundingSegment>& tableSegments,
+               float max_ball_radius);
+
+    bool   empty() const { return distance.empty(); }
+    size_t segmentCount() const { return num_segments; }
+    float  maxBallRadius() const { return max_radius; }
+
+    // Bytes alocados pelo campo (cresce com a área em volta dos segmentos)
+    size_t memoryUsage() const
+    {
+        return distance.capacity() * sizeof(float) + cellStart.capacity() * sizeof(uint32_t) +
+               cellSegments.capacity() * sizeof(uint16_t);
+    }
+
+    // true se uma bola de raio r centrada em (x, z) pode estar encostando em
+    // algum segmento. Nunca dá falso negativo: a distância é 1-Lipschitz, então
+    // a interpolação erra no máximo cell_size * sqrt(2).
+    bool mayTouch(float x, float z, float r) const;
+
+    // Segmentos candidatos da célula que contém (x, z). Fora do campo a lista
+    // é vazia.
+    void candidates(float x, float z, const uint16_t*& begin, const uint16_t*& end) const;
+
+private:
+    float  min_x, min_z;   // Canto do campo
+    float  cell_size;
+    float  max_radius;
+    float  contact_margin; // cell_size * sqrt(2)
+    int    cols, rows;     // Número de células em X e em Z
+    size_t num_segments;
+
+    std::vector<float>    distance;     // (cols + 1) * (rows + 1) vértices, linha = coluna X
+    std::vector<uint32_t> cellStart;    // cols * rows + 1 posições
+    std::vector<uint16_t> cellSegments; // Candidatos agrupados por célula
+
+    bool cellOf(float x, float z, int& col, int& row, float& fx, float& fz) const;
+};
@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Evento produzido pela física para a lógica do jogo, log e estatísticas
+struct PhysicsEvent
+{
+    enum Type : uint8_t {
+        BALL_POCKETED,     // Bola numerada caiu na caçapa (fica inativa)
+        CUE_BALL_POCKETED, // Bola branca caiu na caçapa (foi reposicionada)
+        BALL_BALL,         // Choque entre duas bolas
+        BALL_CUSHION       // Choque com tabela ou entrada de caçapa
+    };
+
+    Type    type;
+    int32_t ball;  // Índice da bola em BallState
+    int32_t other; // Caçapa, outra bola ou segmento (pocketSegments seguidos de tableSegments)
+    float   time;  // Tempo simulado do evento, em segundos
+};
+
+// Fila circular de capacidade fixa, sem locks, para exatamente um produtor
+// (a física) e um consumidor (a lógica do jogo). CAPACITY precisa ser
+// potência de 2. Quando a fila está cheia o evento é descartado e contado em
+// overflowCount(), para a física nunca esperar pelo consumidor.
+template <typename T, size_t CAPACITY>
+class SpscRing
+{
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+
+public:
+    SpscRing() : head(0), tail(0), overflow(0) {}
+
+    // Copiar só é seguro com produtor e consumidor parados (ex.: ao copiar
+    // um PhysicsWorld inteiro).
+    SpscRing(const SpscRing& other) : head(0), tail(0), overflow(0) { *this = other; }
+    SpscRing& operator=(const SpscRing& other)
+    {
+        size_t h = other.head.load(std::memory_order_relaxed);
+        size_t t = other.tail.load(std::memory_order_relaxed);
+        for (size_t i = t; i != h; ++i)
+            items[i & (CAPACITY - 1)] = other.items[i & (CAPACITY - 1)];
+        head.store(h, std::memory_order_relaxed);
+        tail.store(t, std::memory_order_relaxed);
+        overflow.store(other.overflow.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+
+    // Produtor
+    bool push(const T& item)
+    {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == CAPACITY)
+        {
+            overflow.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        items[h & (CAPACITY - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumidor
+    bool pop(T& item)
+    {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire))
+            return false;
+        item = items[t & (CAPACITY - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t    capacity() const { return CAPACITY; }
+    long long overflowCount() const { return overflow.load(std::memory_order_relaxed); }
+
+private:
+    T items[CAPACITY];
+    // head e tail separados por preenchimento para o produtor e o consumidor
+    // não disputarem a mesma linha de cache. (alignas exigiria new alinhado,
+    // que o C++11 não garante para um PhysicsWorld dentro de std::vector.)
+    char pad0[64];
+    std::atomic<size_t> head; // Próxima posição a escrever (só o produtor altera)
+    char pad1[64];
+    std::atomic<size_t> tail; // Próxima posição a ler (só o consumidor altera)
+    char pad2[64];
+    std::atomic<long long> overflow;
+};
+
+// Capacidade da fila de eventos de cada PhysicsWorld
+const size_t PHYSICS_EVENT_CAPACITY = 1024;
+
+typedef SpscRing<PhysicsEvent, PHYSICS_EVENT_CAPACITY> PhysicsEventRing;
@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <queue>
+#include <vector>
+#include "PhysicsWorld.h"
+#include "BallMotion.h"
+
+// Estatísticas de uma simulação orientada a eventos
+struct EventStats {
+    long long events;      // Eventos processados (inclui paradas de bolas)
+    long long ball_ball;   // Colisões entre bolas
+    long long cushion;     // Colisões com tabelas e entradas de caçapa
+    long long pocket;      // Bolas encaçapadas
+    long long discarded;   // Eventos invalidados antes de serem processados
+    float     sim_time;    // Tempo simulado até as bolas pararem
+};
+
+// Modo de simulação orientado a eventos (colisão contínua). Em vez de
+// avançar em passos fixos de 1/120 s, calcula o instante exato de cada
+// colisão bola-bola, bola-segmento (BoundingSegment) e bola-caçapa e salta
+// diretamente de um evento para o próximo, usando uma fila de prioridade.
+//
+// O movimento é o mesmo do passo fixo (BallTrajectory): deslize, rolamento
+// e parada, cada fase um polinômio de grau 2 no tempo. A troca de fase é um
+// evento; entre dois eventos de uma bola a fase não muda, e o instante de
+// contato é achado por avanço conservador (a distância até o contato nunca
+// diminui mais rápido que a maior velocidade relativa no intervalo, que fica
+// em uma das pontas porque a velocidade é linear no tempo). Não há passo de
+// tempo, então não existe tunelamento através das tabelas.
+//
+// A simulação é feita no plano da mesa: a coordenada Y das bolas é mantida.
+class EventSimulation
+{
+public:
+    explicit EventSimulation(PhysicsWorld& world);
+
+    // Simula a partir do estado atual do mundo até todas as bolas pararem ou
+    // até max_time segundos, e escreve o estado final de volta no mundo.
+    EventStats run(float max_time);
+
+private:
+    enum EventType { BALL_BALL, BALL_SEGMENT, BALL_POCKET, BALL_PHASE };
+
+    struct Event {
+        float     time;
+        EventType type;
+        uint32_t  a, b;             // Bola a; b é a outra bola, o segmento ou a caçapa
+        uint32_t  count_a, count_b; // Contadores de colisão quando o evento foi previsto
+        bool operator>(const Event& other) const { return time > other.time; }
+    };
+
+    // Movimento de uma bola desde o último evento em que ela participou
+    struct Motion {
+        float t0;            // Instante de referência
+        BallTrajectory path; // Trajetória a partir de t0 (tempo relativo a t0)
+    };
+
+    PhysicsWorld& world;
+    std::vector<Motion>   motion;
+    std::vector<uint32_t> collision_count;
+    std::vector<BoundingSegment> segments; // Tabelas + entradas das caçapas
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event> > queue;
+    float now;
+
+    glm::vec2 PositionAt(uint32_t i, float t) const;
+    glm::vec2 VelocityAt(uint32_t i, float t) const;
+    glm::vec2 SpinAt(uint32_t i, float t) const;
+    glm::vec2 AccelerationAt(uint32_t i, float t) const;
+    float     NextPhaseChange(uint32_t i) const;
+    void      SetMotion(uint32_t i, const glm::vec2& position, const glm::vec2& velocity, const glm::vec2& spin);
+    void      AdvanceOrientation(uint32_t i, float t);
+    void      Predict(uint32_t i);
+    void      Push(EventType type, float time, uint32_t a, uint32_t b);
+    void      Emit(PhysicsEvent::Type type, uint32_t ball, uint32_t other);
+};
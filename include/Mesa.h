@@ -0,0 +1,56 @@
+#pragma once
+#include <vector>
+#include <glm/glm.hpp>
+#include "game_objects.h"
+#include "PhysicsWorld.h"
+
+// Monta a mesa padrão: bola branca, rack triangular com as 15 bolas
+// numeradas, segmentos das tabelas, entradas das caçapas e caçapas.
+// Os parâmetros da mesa voltam ao padrão (TableParameters, a mesa de 9 pés
+// do jogo).
+void MontarMesaPadrao(PhysicsWorld& world);
+
+// Substitui a mesa (parâmetros, tabelas, entradas das caçapas e caçapas) pela
+// descrita em um arquivo texto, como os de data/mesas, e arruma as bolas
+// como em MontarMesaPadrao, com o raio e os pontos da mesa nova. Cada linha
+// não vazia que não começa com '#' tem uma palavra-chave e seus valores:
+//
+//   nome <texto>                  largura <x>          comprimento <z>
+//   raio_bola <r>                 altura_bola <y>      gravidade <g>
+//   restituicao_bola <e>          restituicao_tabela <e>
+//   atrito_deslize <mu_s>         atrito_rolamento <mu_r>
+//   bola_branca <x> <z>           rack <x> <z>
+//   tabela <x1> <z1> <x2> <z2>    (linha do centro da bola encostada na tabela)
+//   entrada_cacapa <x1> <z1> <x2> <z2>
+//   cacapa <x> <z> <raio>
+//
+// Valores ausentes ficam com o padrão de TableParameters. Dimensões, raio,
+// gravidade e atritos precisam ser positivos e as restituições ficar entre 0
+// e 1. Retorna false (sem alterar a mesa) se o arquivo não puder ser lido ou
+// tiver alguma linha inválida.
+bool CarregarMesa(const char* filename, PhysicsWorld& world);
+
+// Monta uma mesa de bilhar retangular com área de jogo width x depth (metros,
+// comprimento em Z), 6 caçapas e as bocas das caçapas da mesa de 7 pés,
+// mantendo o raio das bolas e os coeficientes de world.parameters. Os pontos
+// da bola branca e do rack ficam a um quarto do comprimento. Remove todas
+// as bolas. Serve para testes de estresse com milhares de bolas.
+void MontarMesaRetangular(PhysicsWorld& world, float width, float depth);
+
+// Substitui as bolas da mesa por um layout lido de um arquivo texto. Cada
+// linha não vazia que não começa com '#' tem o formato
+// "bola <numero> <x> <z>". A bola de número 0 é a bola branca. As bolas
+// usam o raio e a altura de world.parameters. Retorna false (sem alterar a
+// mesa) se o arquivo não puder ser lido ou tiver alguma linha inválida.
+bool CarregarLayoutMesa(const char* filename, PhysicsWorld& world);
+
+// Velocidade aplicada à bola branca para uma tacada com o ângulo de mira
+// (no plano XZ) e a força em porcentagem (0.0 a 100.0).
+glm::vec3 VelocidadeDaTacada(float aimingAngle, float powerPercentage);
+
+// Inverso de VelocidadeDaTacada: força, em porcentagem, que dá à bola branca
+// a velocidade speed. Fora de 0 a 100 se a tacada não alcança essa velocidade.
+float ForcaDaTacada(float speed);
+
+// true se nenhuma bola ativa está se movendo ou girando no plano da mesa
+bool BolasParadas(const BallState& balls);
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Narrowphase bola-bola: testa uma bola (x, y, z, r) contra count bolas
+// candidatas (índices em candidates) comparando distâncias ao quadrado, sem
+// raiz quadrada. Escreve em hits as posições k (em ordem crescente) dos
+// candidatos que se sobrepõem à bola, ou seja, |p - p[candidates[k]]|^2 <
+// (r + radius[candidates[k]])^2, e retorna quantas foram. hits precisa ter
+// espaço para count posições.
+typedef size_t (*NarrowphaseKernel)(const float* px, const float* py, const float* pz,
+                                    const float* radius,
+                                    const uint32_t* candidates, size_t count,
+                                    float x, float y, float z, float r,
+                                    uint32_t* hits);
+
+// Melhor implementação suportada pela CPU em que o programa está rodando:
+// AVX2 (8 candidatos por vez), SSE2 (4 por vez) ou escalar.
+NarrowphaseKernel EscolherNarrowphase();
+
+// Implementação pelo nome ("scalar", "sse2" ou "avx2"). Retorna NULL se o
+// nome for desconhecido ou se a CPU não suportar as instruções.
+NarrowphaseKernel NarrowphasePorNome(const char* name);
+
+// Nome da implementação ("scalar", "sse2" ou "avx2")
+const char* NomeDaNarrowphase(NarrowphaseKernel kernel);
@@ -0,0 +1,107 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include "PhysicsWorld.h"
+#include "EventRing.h"
+#include "TripleBuffer.h"
+
+// Estado das bolas publicado pela thread da física para o desenho. Depois
+// de publicado não muda mais, até o leitor trocar de buffer.
+struct BallSnapshot
+{
+    std::vector<glm::vec3> previous_position;    // Antes do último passo fixo
+    std::vector<glm::vec3> position;             // Depois do último passo fixo
+    std::vector<glm::quat> previous_orientation;
+    std::vector<glm::quat> orientation;
+    std::vector<float>     radius;
+    std::vector<uint8_t>   active;
+    float  alpha;           // PhysicsWorld::interpolationAlpha() na publicação
+    float  fixed_time_step;
+    bool   stopped;         // Nenhuma bola se movendo (BolasParadas)
+    double sim_time;
+    double dropped_time;    // PhysicsWorld::droppedTime()
+    std::chrono::steady_clock::time_point published_at;
+
+    BallSnapshot() : alpha(0.0f), fixed_time_step(1.0f / 120.0f), stopped(true), sim_time(0.0), dropped_time(0.0) {}
+
+    size_t size() const { return position.size(); }
+    bool   empty() const { return position.empty(); }
+
+    // Fração de interpolação no instante now: alpha mais o tempo passado
+    // desde a publicação, limitada a 1 (se a física atrasar, a bola para na
+    // última posição em vez de ser extrapolada).
+    float interpolationAlpha(std::chrono::steady_clock::time_point now) const;
+
+    glm::vec3 renderPosition(size_t i, float t) const;
+    glm::quat renderOrientation(size_t i, float t) const;
+};
+
+// Comando do jogo para a física, aplicado entre dois passos fixos
+struct PhysicsCommand
+{
+    enum Type : uint8_t {
+        SET_VELOCITY, // Tacada: nova velocidade da bola
+        SET_POSITION  // Bola reposicionada (bola branca na mão), parada
+    };
+
+    Type      type;
+    int32_t   ball;
+    glm::vec3 value;
+};
+
+// Capacidade da fila de comandos do jogo para a física
+const size_t PHYSICS_COMMAND_CAPACITY = 64;
+
+typedef SpscRing<PhysicsCommand, PHYSICS_COMMAND_CAPACITY> PhysicsCommandRing;
+
+// Roda um PhysicsWorld em uma thread própria, em passos fixos no ritmo do
+// relógio, sem depender da taxa de quadros do desenho (e sem atrasá-la).
+// Depois de cada passo o estado das bolas é publicado em um buffer triplo;
+// o desenho pega o mais recente com latest() sem esperar. O jogo só fala com
+// a física pelos comandos (setVelocity, setPosition) e lê os eventos em
+// world.events: enquanto a thread roda, ninguém mais pode acessar o mundo.
+//
+// Todas as funções públicas são do lado do jogo e devem ser chamadas sempre
+// da mesma thread.
+class PhysicsThread
+{
+public:
+    explicit PhysicsThread(PhysicsWorld& world);
+    ~PhysicsThread();
+
+    // Publica o estado atual e começa a simular. stop() espera a thread
+    // terminar; depois dele o mundo pode ser acessado de novo.
+    void start();
+    void stop();
+    bool running() const { return thread.joinable(); }
+
+    // Enfileira um comando. Retorna false se a fila estiver cheia.
+    bool setVelocity(size_t ball, const glm::vec3& velocity);
+    bool setPosition(size_t ball, const glm::vec3& position);
+
+    // Passa para o estado publicado mais recente, se houver um novo, e o
+    // retorna. Nunca bloqueia. A referência vale até a próxima chamada.
+    const BallSnapshot& latest();
+
+    // Estado obtido na última chamada de latest()
+    const BallSnapshot& snapshot() const { return snapshots.readBuffer(); }
+
+private:
+    PhysicsWorld&              world;
+    std::thread                thread;
+    std::atomic<bool>          quit;
+    PhysicsCommandRing         commands;
+    TripleBuffer<BallSnapshot> snapshots;
+
+    void run();
+    bool applyCommands();
+    void publish();
+
+    PhysicsThread(const PhysicsThread&);
+    PhysicsThread& operator=(const PhysicsThread&);
+};
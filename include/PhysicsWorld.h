@@ -0,0 +1,273 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "game_objects.h"
+#include "BallState.h"
+#include "DistanceField.h"
+#include "Narrowphase.h"
+#include "EventRing.h"
+#include "TableParameters.h"
+
+// Constantes da simulação, as mesmas para a física, para quem espera as bolas
+// pararem (BolasParadas), para quem dá os passos de fora (sinuca_sim) e para
+// quem salva e restaura as bolas (TableState)
+const float VELOCITY_STOP_THRESHOLD = 0.01f;          // Abaixo disso (m/s) a bola está parada
+const float FIXED_PHYSICS_DELTA_TIME = 1.0f / 120.0f; // Passo de referência do atrito e passo fixo padrão
+const float POCKETED_BALL_POSITION = 1000.0f;         // Bolas encaçapadas ficam em (x, y, z) = este valor, longe da mesa
+
+// Broadphase bola-bola do passo fixo
+enum BroadphaseType {
+    BROADPHASE_GRID,           // Grid uniforme de células de 4 raios padrão, refeito a cada subpasso
+    BROADPHASE_SWEEP_AND_PRUNE // Bolas ordenadas ao longo do comprimento da mesa, reordenadas por inserção
+};
+
+// Broadphase pelo nome ("grid" ou "sap"). Retorna false se o nome for desconhecido.
+bool BroadphasePorNome(const char* name, BroadphaseType& type);
+
+// Nome da broadphase ("grid" ou "sap")
+const char* NomeDaBroadphase(BroadphaseType type);
+
+class ThreadPool;
+struct TableState;
+
+// Mundo físico de uma mesa de sinuca. Cada instância é dona das suas bolas,
+// tabelas, caçapas, grid espacial e acumulador de tempo, de modo que várias
+// mesas independentes podem ser simuladas ao mesmo tempo, uma por thread.
+class PhysicsWorld
+{
+public:
+    BallState                    balls;          // A bola 0 é a bola branca
+    std::vector<BoundingSegment> tableSegments;  // Tabelas internas da mesa
+    std::vector<BoundingSegment> pocketSegments; // Entradas das caçapas
+    std::vector<Pocket>          pockets;
+
+    // Dimensões da mesa e coeficientes físicos. O grid espacial é
+    // dimensionado a partir deles (e do raio das bolas) a cada subpasso.
+    TableParameters parameters;
+
+    // Eventos da simulação (bolas encaçapadas, choques), produzidos pelo
+    // passo e consumidos fora dele pela lógica do jogo, log ou estatísticas.
+    // Um produtor (quem chama step/SimularColisoes) e um consumidor.
+    PhysicsEventRing events;
+
+    // Tempo simulado desde a criação do mundo, em segundos
+    double simTime;
+
+    // Teste bola-bola usado pelo passo fixo. O construtor escolhe o melhor
+    // para a CPU (AVX2, SSE2 ou escalar); pode ser trocado para comparações.
+    NarrowphaseKernel narrowphase;
+
+    // Como os pares candidatos são encontrados (grid por padrão). O grid tem
+    // células do tamanho da bola padrão e piora com bolas de raios muito
+    // diferentes; o sweep-and-prune não depende do raio nem do tamanho da
+    // mesa, e como as bolas mudam pouco de ordem entre subpassos, a
+    // reordenação por inserção custa quase O(n).
+    BroadphaseType broadphase;
+
+    // Threads usadas pelo passo fixo (NULL, o padrão, faz tudo na thread que
+    // chama). Com muitas bolas acordadas, a integração, a busca de contatos,
+    // as tabelas e caçapas e o solver (ilha de contatos por ilha) são
+    // divididos entre as threads, e o resultado é o mesmo, bit a bit, com
+    // qualquer número delas. O mundo não é dono do pool; mundos que não dão
+    // passos ao mesmo tempo podem compartilhar um.
+    ThreadPool* threadPool;
+
+    PhysicsWorld();
+
+    // Com false a física não acompanha o rolamento das bolas (orientation
+    // fica parada). Simulações sem desenho não precisam da orientação.
+    bool integrateOrientation;
+
+    // Duração do passo fixo, em segundos (1/120 por padrão). Como o desenho
+    // interpola entre os dois últimos passos, máquinas fracas podem usar
+    // 1/60 ou menos sem engasgos visíveis; o atrito é ajustado ao passo.
+    float fixedTimeStep;
+
+    // Número fixo de subpassos por passo fixo. Com 0 (o padrão) o número é
+    // adaptativo: escolhido a cada passo pela bola mais rápida, de modo que
+    // nenhuma bola ande mais que meio raio por subpasso.
+    int fixedSubsteps;
+
+    // Limites de step() por chamada: no máximo maxStepsPerFrame passos fixos
+    // e maxFrameTime segundos de relógio (0 desliga o limite). O tempo de
+    // simulação que não coube é descartado e contado em droppedTime().
+    int   maxStepsPerFrame;
+    float maxFrameTime;
+
+    // Acumula deltaTime e executa quantos passos fixos couberem no tempo
+    // acumulado, respeitando os limites acima. Sempre executa pelo menos um
+    // passo se houver um passo inteiro acumulado. Retorna o número de passos
+    // executados.
+    int step(float deltaTime);
+
+    // Executa exatamente um passo fixo de simulação (fixedTimeStep), dividido em
+    // subpassos. Retorna o número de subpassos; 0 se todas as bolas dormem.
+    int SimularColisoes();
+
+    // Tempo acumulado que ainda não foi simulado (menor que um passo fixo)
+    float accumulator() const { return physics_accumulator; }
+
+    // Fração do próximo passo fixo já acumulada, de 0 a 1
+    float interpolationAlpha() const { return physics_accumulator / fixedTimeStep; }
+
+    // Posição e orientação da bola i para desenho: interpolação entre o
+    // estado antes e depois do último passo executado por step(), usando
+    // interpolationAlpha(). Saltos grandes (bola encaçapada, bola branca
+    // reposicionada) não são interpolados.
+    glm::vec3 renderPosition(size_t i) const { return renderPosition(i, interpolationAlpha()); }
+    glm::quat renderOrientation(size_t i) const { return renderOrientation(i, interpolationAlpha()); }
+
+    // O mesmo para uma fração alpha qualquer (0 = antes do último passo,
+    // 1 = depois dele)
+    glm::vec3 renderPosition(size_t i, float alpha) const;
+    glm::quat renderOrientation(size_t i, float alpha) const;
+
+    // Aplica o giro acumulado de todas as bolas em BallState::orientation.
+    // step() faz isso uma vez por chamada; quem chama só SimularColisoes()
+    // e lê orientation deve chamar esta função antes.
+    void resolveOrientations();
+
+    // Subpassos executados na última chamada de step() e desde a criação do mundo
+    int       substepsLastFrame() const { return frame_substeps; }
+    long long totalSubsteps() const { return total_substeps; }
+
+    // Tempo de simulação descartado pelos limites de step(), na última
+    // chamada e desde a criação do mundo. Se cresce sempre, a máquina não
+    // está dando conta da simulação em tempo real.
+    float  droppedTimeLastFrame() const { return frame_dropped_time; }
+    double droppedTime() const { return dropped_time; }
+
+    // Número de bolas acordadas no último passo. Uma bola que fica parada por
+    // BALL_SLEEP_STEPS passos seguidos dorme: sai da lista de bolas simuladas
+    // e só volta quando outra bola encosta nela ou quando sua posição ou
+    // velocidade é alterada (BallState::wake). Com todas dormindo, um passo
+    // não faz praticamente nada.
+    size_t awakeCount() const { return awakeBalls.size(); }
+
+    // Testes feitos desde a criação do mundo: pares bola-bola passados ao
+    // narrowphase e testes exatos bola-segmento (tabelas e entradas das
+    // caçapas). Servem para medir o trabalho da broadphase e do campo de
+    // distância.
+    long long totalPairTests() const { return pair_tests; }
+    long long totalSegmentTests() const { return segment_tests; }
+
+    // Bytes alocados pelo mundo: bolas, buffers da broadphase e do solver,
+    // campo de distância e eventos. segmentFieldMemoryUsage() é só o campo.
+    size_t memoryUsage() const;
+    size_t segmentFieldMemoryUsage() const { return segmentField.memoryUsage(); }
+
+    // Recalcula o campo de distância das tabelas e caçapas. O passo fixo
+    // refaz o campo sozinho quando o número de segmentos muda; quem altera
+    // as coordenadas dos segmentos deve chamar esta função.
+    void rebuildSegmentField();
+
+    // Esquece o que o passo fixo guarda de um passo para o outro (impulsos
+    // dos contatos e ordem do sweep-and-prune). Quem troca as bolas do mundo
+    // por outras deve chamar esta função, para que o primeiro passo não
+    // parta dos contatos de outra arrumação.
+    void resetContacts();
+
+    // Salva as bolas, quantizadas, em um TableState (TableState.h) de tamanho
+    // fixo, sem alocar. Retorna false se há mais de TABLE_STATE_MAX_BALLS bolas.
+    bool saveState(TableState& state) const;
+
+    // Volta as bolas para um estado salvo desta mesma mesa (mesmo número de
+    // bolas, com os mesmos números), sem alocar, para que a busca da IA e o
+    // desfazer possam ramificar milhares de vezes por segundo. Também
+    // descarta o tempo acumulado por step(), os impulsos guardados do passo
+    // anterior e o instantâneo do desenho. Retorna false se o estado é de
+    // outra mesa.
+    bool restoreState(const TableState& state);
+
+private:
+    // Grid espacial plano, montado por counting sort a cada passo. As bolas
+    // da célula c são gridBallIndices[gridCellStart[c] .. gridCellStart[c+1]-1],
+    // em ordem crescente de índice. Os vetores só crescem quando o número de
+    // bolas aumenta, então um passo normal não faz alocações no heap.
+    //
+    // O grid cobre a mesa (parameters.width x parameters.depth) com células
+    // de 4 vezes o maior raio, aumentadas se a mesa for grande demais para o
+    // número de bolas. Bolas fora da mesa caem na célula da borda.
+    float                 gridCellSize;
+    int                   gridCols;
+    int                   gridRows;
+    std::vector<uint32_t> gridCellStart;   // gridCols * gridRows + 1 posições
+    std::vector<uint32_t> gridBallIndices; // Índices das bolas ativas, agrupados por célula
+    std::vector<int32_t>  ballCell;        // Célula de cada bola (-1 se inativa)
+    std::vector<uint32_t> awakeBalls;      // Bolas ativas e acordadas, em ordem crescente
+    // Sweep-and-prune: todas as bolas, ordenadas pelo início do intervalo no
+    // eixo do comprimento da mesa (Z, ou X se a mesa for mais larga que
+    // comprida; p - radius, guardado em sweepMin). Bolas inativas ficam no
+    // fim, com sweepMin infinito. A ordem é mantida de um subpasso para o outro.
+    std::vector<uint32_t> sweepOrder;
+    std::vector<float>    sweepMin;
+    float                 sweepMaxRadius; // Maior raio entre as bolas ativas
+    SegmentDistanceField  segmentField;    // Campo de distância de pocketSegments + tableSegments
+    std::vector<std::vector<uint32_t> > threadHits; // Saída do narrowphase, uma por thread
+    float physics_accumulator;
+    std::vector<glm::vec3> previous_position;    // Estado antes do último passo de step()
+    std::vector<glm::vec3> previous_rotation;    // BallState::rotation antes do último passo
+    int       frame_substeps;
+    long long total_substeps;
+    float     frame_dropped_time;
+    double    dropped_time;
+    long long pair_tests;
+    long long segment_tests;
+
+    // Contato bola-bola de um passo. normal aponta de b para a.
+    struct BallContact {
+        uint32_t  a, b;
+        glm::vec3 normal;
+        float     bounce_velocity; // Velocidade relativa normal desejada após o choque
+        float     impulse;         // Impulso normal acumulado
+    };
+    // Impulso acumulado de um par no passo anterior
+    struct CachedImpulse {
+        uint64_t key; // Menor índice nos 32 bits altos, maior nos baixos
+        float    impulse;
+    };
+    std::vector<BallContact>   contacts;
+    std::vector<CachedImpulse> contactCache; // Ordenado por key
+
+    // Resultado de um pedaço do trabalho de um subpasso. Os pedaços rodam em
+    // qualquer ordem e em qualquer thread, mas são juntados na ordem em que
+    // aparecem (mergeChunks), então contatos e eventos saem na mesma ordem
+    // que sairiam sem threads.
+    struct WorkChunk {
+        std::vector<BallContact>  contacts;
+        std::vector<PhysicsEvent> events;
+        std::vector<uint32_t>     woken; // Bolas dormindo tocadas, acordadas ao juntar
+        long long pair_tests;
+        long long segment_tests;
+        WorkChunk() : pair_tests(0), segment_tests(0) {}
+    };
+    std::vector<WorkChunk> workChunks;
+
+    // Ilhas de contatos (bolas ligadas por contatos), resolvidas de forma
+    // independente. Os contatos da ilha k são
+    // islandContacts[islandStart[k] .. islandStart[k+1]-1], na ordem original.
+    std::vector<uint32_t> islandParent;   // Union-find sobre as bolas
+    std::vector<int32_t>  islandOf;       // Ilha de cada raiz (-1 fora de uso)
+    std::vector<uint32_t> islandStart;
+    std::vector<uint32_t> islandContacts;
+    std::vector<uint32_t> islandBatchStart; // Ilhas agrupadas em tarefas de tamanho parecido
+
+    size_t chunkCount(size_t count) const;
+    void runChunks(size_t num_chunks, size_t count,
+                   const std::function<void(size_t, size_t, WorkChunk&, unsigned)>& work);
+    void mergeChunks(size_t num_chunks);
+    void bufferEvent(WorkChunk& chunk, PhysicsEvent::Type type, size_t ball, size_t other) const;
+    void saveRenderSnapshot();
+    void substep(float dt);
+    void integrateBalls(size_t begin, size_t end, float dt);
+    void updateSpatialGrid();
+    void updateSweepAndPrune();
+    void collectContacts(bool any_asleep, size_t begin, size_t end, WorkChunk& chunk, uint32_t* hits);
+    void collectSweepContacts(bool any_asleep, size_t begin, size_t end, WorkChunk& chunk, uint32_t* hits);
+    void addContact(uint32_t i, uint32_t j, WorkChunk& chunk);
+    void collideWithTable(size_t begin, size_t end, WorkChunk& chunk);
+    void solveContacts(size_t num_chunks);
+    void buildIslands(size_t num_batches);
+    void solveContactList(const uint32_t* list, size_t count);
+};
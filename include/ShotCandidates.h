@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "PhysicsWorld.h"
+#include "ShotEvaluator.h"
+
+class ThreadPool;
+
+// Tipo de tacada gerada pela geometria da bola fantasma
+enum ShotKind {
+    SHOT_DIRECT,     // Branca -> bola -> caçapa
+    SHOT_BANK,       // Branca -> bola -> tabela -> caçapa
+    SHOT_COMBINATION // Branca -> bola -> outra bola -> caçapa
+};
+
+// Nome do tipo de tacada ("direta", "tabela" ou "combinação")
+const char* NomeDoTipoDeTacada(ShotKind kind);
+
+// Tacada candidata. A mira aponta o centro da bola branca para a "bola
+// fantasma": a posição em que ela encosta na primeira bola de modo que essa
+// bola saia na direção desejada.
+struct ShotCandidate
+{
+    ShotParameters shot;   // Mira e força estimada
+    ShotKind kind;
+    int32_t  ball;         // Índice da primeira bola acertada pela branca
+    int32_t  target;       // Índice da bola que deve cair (a mesma de ball, exceto em combinações)
+    int32_t  pocket;       // Índice em pockets
+    int32_t  cushion;      // Índice em tableSegments da tabela usada (SHOT_BANK), senão -1
+    float    cut_angle;    // Ângulo de corte na primeira bola, em radianos (0 = tacada reta)
+    float    prior;        // Estimativa analítica da chance de acerto, de 0 a 1; maior é melhor
+};
+
+// Quais tacadas GerarCandidatas procura
+struct CandidateSettings
+{
+    uint32_t target_mask;   // Bit n ligado: a bola de número n pode ser encaçapada
+    bool     banks;
+    bool     combinations;
+    float    max_cut_angle; // Cortes mais finos que isso são descartados, em radianos
+
+    CandidateSettings()
+        : target_mask(0xFFFEu), // Todas as bolas numeradas
+          banks(true),
+          combinations(true),
+          max_cut_angle(1.31f)   // 75 graus
+    {
+    }
+};
+
+// Enumera tacadas diretas, de tabela e combinações para todas as bolas
+// permitidas e todas as caçapas, pela geometria da bola fantasma. Descarta
+// as impossíveis: caminhos (cápsulas do tamanho da bola) bloqueados por
+// outras bolas ou tabelas, cortes finos demais e forças acima de 100%.
+// Retorna as candidatas da maior prior para a menor.
+std::vector<ShotCandidate> GerarCandidatas(const PhysicsWorld& table, const CandidateSettings& settings);
+
+// Gera as candidatas, simula só as max_candidates melhores com
+// AvaliarTacadas e retorna os resultados, do maior score para o menor. Se
+// nenhuma tacada geométrica for possível (bola branca cercada), avalia uma
+// grade grossa de ângulos e forças no lugar delas. simulations é o mesmo
+// de AvaliarTacadas.
+std::vector<ShotOutcome> AvaliarCandidatas(const PhysicsWorld& table, size_t max_candidates,
+                                           const CandidateSettings& candidates, const ShotEvaluation& settings,
+                                           ThreadPool* pool, long long* simulations = NULL);
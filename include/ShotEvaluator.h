@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "PhysicsWorld.h"
+
+class ThreadPool;
+class TranspositionCache;
+
+// Tacada na bola branca: ângulo de mira no plano XZ, em radianos (mesma
+// convenção de g_AimingAngle), e força em porcentagem (0.0 a 100.0).
+struct ShotParameters
+{
+    float angle;
+    float power;
+};
+
+// Como AvaliarTacadas simula cada tacada
+struct ShotEvaluation
+{
+    // Simulações por tacada. A primeira é a tacada exata; as outras somam ao
+    // ângulo e à força um ruído normal com os desvios abaixo, imitando a
+    // imprecisão de um jogador.
+    int      noise_samples;
+    float    angle_noise;     // Desvio padrão, em radianos
+    float    power_noise;     // Desvio padrão, em pontos percentuais
+    uint32_t seed;            // Semente do ruído; o resultado só depende dela
+    float    max_time;        // Tempo simulado máximo por simulação, em segundos
+    float    scratch_penalty; // Quanto uma bola branca encaçapada desconta do score
+
+    // Cache dividida entre as buscas (TranspositionCache.h); NULL desliga.
+    // Tacadas já avaliadas com os mesmos ajustes a partir de uma mesa com o
+    // mesmo TableState não são simuladas de novo. A chave não tem a mesa em
+    // si (tabelas, caçapas, coeficientes): uma cache serve a uma mesa só.
+    TranspositionCache* cache;
+
+    ShotEvaluation()
+        : noise_samples(4),
+          angle_noise(0.004f),
+          power_noise(2.0f),
+          seed(1234),
+          max_time(20.0f),
+          scratch_penalty(1.0f),
+          cache(NULL)
+    {
+    }
+};
+
+// Resultado de uma tacada. As médias são sobre as noise_samples simulações;
+// a posição da bola branca e as bolas encaçapadas são as da tacada exata.
+struct ShotOutcome
+{
+    ShotParameters shot;
+    float     potted;       // Bolas numeradas encaçapadas, em média
+    float     scratch_rate; // Fração das simulações com a bola branca encaçapada
+    float     sim_time;     // Tempo simulado médio até as bolas pararem
+    glm::vec2 cue_position; // Posição final (x, z) da bola branca
+    uint32_t  potted_mask;  // Bit n ligado: bola de número n encaçapada
+    bool      scratch;      // A bola branca caiu
+    float     score;        // potted - scratch_penalty * scratch_rate
+};
+
+// Grade de tacadas: angle_steps ângulos em [angle_min, angle_max) e
+// power_steps forças de power_min a power_max (extremos incluídos), com o
+// ângulo variando mais rápido.
+std::vector<ShotParameters> GradeDeTacadas(float angle_min, float angle_max, int angle_steps,
+                                           float power_min, float power_max, int power_steps);
+
+// Simula cada tacada a partir da mesa como ela está (posições e velocidades
+// de table.balls; a bola 0 precisa ser a bola branca) até todas as bolas
+// pararem ou max_time. As simulações são divididas entre as threads de pool
+// (NULL faz tudo na thread que chama), cada thread com uma cópia própria da
+// mesa. As simulações partem da mesa restaurada do seu TableState (posições
+// e velocidades quantizadas, TableState.h), então o resultado só depende do
+// estado, das tacadas e dos ajustes: é o mesmo com ou sem cache e com
+// qualquer número de threads. Se simulations não é NULL, soma nele as simulações feitas (as
+// tacadas achadas na cache não contam).
+std::vector<ShotOutcome> AvaliarTacadas(const PhysicsWorld& table, const std::vector<ShotParameters>& shots,
+                                        const ShotEvaluation& settings, ThreadPool* pool,
+                                        long long* simulations = NULL);
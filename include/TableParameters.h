@@ -0,0 +1,49 @@
+#pragma once
+#include <string>
+#include <glm/glm.hpp>
+
+// Dimensões e coeficientes físicos de uma mesa. O construtor dá a mesa de
+// 9 pés do jogo (a do modelo 3D); outras mesas são lidas de arquivos em
+// data/mesas com CarregarMesa (Mesa.h). A mesa fica centrada na origem,
+// com o comprimento ao longo de Z.
+struct TableParameters
+{
+    std::string name;
+
+    float width;    // Área de jogo em X (até o nariz das tabelas), em metros
+    float depth;    // Área de jogo em Z
+    float ball_radius;
+    float ball_y;   // Altura do centro das bolas apoiadas no pano
+
+    float gravity;
+    float ball_restitution;    // Choque bola-bola
+    float cushion_restitution; // Choque com as tabelas e quique no pano
+    float sliding_friction;    // Atrito cinético bola-pano (mu_s)
+    float rolling_friction;    // Resistência ao rolamento (mu_r)
+
+    glm::vec2 cue_ball_spot; // (x, z) onde a bola branca começa e volta depois de encaçapada
+    glm::vec2 rack_apex;     // (x, z) da bola da ponta do rack
+
+    // Os coeficientes padrão são os do jogo. O de deslize é o valor usual de
+    // pano de sinuca; o de rolamento é mais alto que o de um pano real
+    // (~0.01) para as tacadas durarem o mesmo que no modelo antigo de
+    // atrito por passo.
+    TableParameters()
+        : name("9ft"),
+          width(1.0415f),
+          depth(2.2845f),
+          ball_radius(0.02625f),
+          ball_y(-0.2667f),
+          gravity(9.8f),
+          ball_restitution(0.8f),
+          cushion_restitution(0.8f),
+          sliding_friction(0.2f),
+          rolling_friction(0.06f),
+          cue_ball_spot(-0.0020f, 0.5680f),
+          rack_apex(0.0f, -0.60f)
+    {
+    }
+
+    // Altura da superfície do pano
+    float feltY() const { return ball_y - ball_radius; }
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Número máximo de bolas em um TableState (a branca e as 15 numeradas)
+const int TABLE_STATE_MAX_BALLS = 16;
+
+// Passos da quantização. Com int16, as posições cobrem +-4 m (mesas de
+// snooker incluídas) em passos de 0,12 mm, e as velocidades +-16 m/s (acima
+// da tacada mais forte) em passos de 0,5 mm/s.
+const float TABLE_STATE_POSITION_QUANTUM = 1.0f / 8192.0f;    // Metros
+const float TABLE_STATE_VELOCITY_QUANTUM = 1.0f / 2048.0f;    // Metros por segundo
+const float TABLE_STATE_ORIENTATION_SCALE = 32767.0f;         // Componentes do quatérnio, de -1 a 1
+
+// Bits de PackedBall::flags
+enum {
+    PACKED_BALL_ACTIVE = 1 << 0, // A bola está na mesa (BallState::active)
+    PACKED_BALL_ASLEEP = 1 << 1  // BallState::asleep
+};
+
+// Uma bola quantizada, 28 bytes sem padding
+struct PackedBall
+{
+    int16_t  position[3];    // x, y, z
+    int16_t  velocity[3];    // x, y, z
+    int16_t  spin[2];        // BallState::spinVelocity (x, z), na mesma escala da velocidade
+    int16_t  orientation[4]; // w, x, y, z, já com o giro pendente aplicado
+    uint16_t still_steps;
+    int8_t   number;
+    uint8_t  flags;
+};
+
+// Estado compacto das bolas de uma mesa, para a busca da IA e para desfazer
+// tacadas: tamanho fixo, sem ponteiros, copiável com memcpy. Posições não
+// usadas e o campo reserved ficam zerados, então dois estados iguais têm os
+// mesmos bytes, e comparar e calcular o hash é olhar a memória inteira.
+// O tempo simulado, a fila de eventos e a mesa em si (tabelas, caçapas,
+// coeficientes) não fazem parte do estado.
+struct TableState
+{
+    uint16_t   count;    // Bolas usadas em balls
+    uint16_t   reserved; // Sempre 0
+    PackedBall balls[TABLE_STATE_MAX_BALLS];
+
+    // Hash FNV-1a de 64 bits dos bytes do estado
+    uint64_t hash() const;
+
+    bool operator==(const TableState& other) const { return std::memcmp(this, &other, sizeof(TableState)) == 0; }
+    bool operator!=(const TableState& other) const { return !(*this == other); }
+};
+
+static_assert(sizeof(PackedBall) == 28, "PackedBall must not have padding");
+static_assert(sizeof(TableState) == 4 + TABLE_STATE_MAX_BALLS * sizeof(PackedBall), "TableState must not have padding");
+static_assert(sizeof(TableState) <= 1024, "TableState must fit in 1 KB");
+static_assert(std::is_trivially_copyable<TableState>::value, "TableState must be trivially copyable");
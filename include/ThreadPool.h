@@ -0,0 +1,50 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Grupo fixo de threads para laços paralelos do tipo fork-join. A thread que
+// chama parallelFor também trabalha e só volta quando todas as tarefas
+// terminaram. As tarefas são distribuídas dinamicamente (cada thread pega a
+// próxima livre), então quem precisa de resultado determinístico deve
+// gravar a saída da tarefa k em um lugar só dela e juntar na ordem de k.
+class ThreadPool
+{
+public:
+    // num_threads conta a thread que chama parallelFor: com 1 não é criada
+    // nenhuma thread e tudo roda direto em parallelFor.
+    explicit ThreadPool(unsigned num_threads);
+    ~ThreadPool();
+
+    // Número de threads, contando a que chama parallelFor
+    unsigned size() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+    // Executa task(k, thread) para k de 0 a count - 1; thread (de 0 a
+    // size() - 1) identifica quem executa, para rascunhos por thread. Não
+    // pode ser chamada de dentro de uma tarefa nem de duas threads ao mesmo
+    // tempo.
+    void parallelFor(size_t count, const std::function<void(size_t, unsigned)>& task);
+
+private:
+    std::vector<std::thread> workers;
+    std::mutex               mutex;
+    std::condition_variable  start_cv;
+    std::condition_variable  done_cv;
+    const std::function<void(size_t, unsigned)>* task; // Trabalho atual
+    size_t                   task_count;
+    std::atomic<size_t>      next_task;
+    unsigned                 busy;       // Threads que ainda não terminaram o trabalho atual
+    uint64_t                 generation; // Muda a cada parallelFor
+    bool                     quit;
+
+    void workerLoop(unsigned thread);
+    void runTasks(unsigned thread);
+
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+};
@@ -0,0 +1,77 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "ShotEvaluator.h"
+
+// Junta duas chaves em uma (para chaves de tacada a partir do hash do
+// TableState da mesa)
+uint64_t MisturarChaves(uint64_t a, uint64_t b);
+
+// Contadores da cache, somados entre as listras
+struct TranspositionStats
+{
+    long long hits;
+    long long misses;
+    long long insertions;
+    long long evictions;
+};
+
+// Cache de resultados de avaliação (ShotOutcome) por chave de 64 bits,
+// dividida entre todas as threads da busca. A memória é fixa, reservada no
+// construtor: as entradas ficam em conjuntos de CACHE_WAYS, e quando o
+// conjunto está cheio o algoritmo do relógio (CLOCK) escolhe quem sai,
+// poupando as entradas usadas desde a última passada do ponteiro. Cada
+// conjunto pertence a uma listra com o seu próprio mutex, então threads
+// diferentes quase nunca esperam umas pelas outras.
+class TranspositionCache
+{
+public:
+    // max_bytes limita a memória das entradas; num_stripes é o número de mutexes
+    explicit TranspositionCache(size_t max_bytes, size_t num_stripes = 64);
+
+    // Procura key. Se achar, copia o resultado em outcome, marca a entrada
+    // como usada e retorna true.
+    bool find(uint64_t key, ShotOutcome& outcome);
+
+    // Guarda (ou substitui) o resultado de key
+    void insert(uint64_t key, const ShotOutcome& outcome);
+
+    // Esvazia a cache e zera os contadores
+    void clear();
+
+    size_t capacity() const { return entries.size(); }
+    size_t memoryUsage() const;
+    TranspositionStats stats() const;
+
+private:
+    static const size_t CACHE_WAYS = 4;
+
+    struct Entry
+    {
+        uint64_t    key;
+        ShotOutcome outcome;
+        uint8_t     used;
+        uint8_t     referenced; // Bit do relógio: usada desde a última passada
+    };
+    struct Stripe
+    {
+        std::mutex mutex;
+        long long  hits;
+        long long  misses;
+        long long  insertions;
+        long long  evictions;
+    };
+
+    std::vector<Entry>   entries;   // numSets * CACHE_WAYS
+    std::vector<uint8_t> clockHand; // Próxima vítima de cada conjunto
+    mutable std::vector<Stripe> stripes;
+    size_t numSets;
+
+    size_t setOf(uint64_t key) const { return static_cast<size_t>((key >> 17) % numSets); }
+    Stripe& stripeOf(size_t set) const { return stripes[set % stripes.size()]; }
+
+    TranspositionCache(const TranspositionCache&);
+    TranspositionCache& operator=(const TranspositionCache&);
+};
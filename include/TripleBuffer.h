@@ -0,0 +1,49 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Buffer triplo sem locks, para exatamente um escritor e um leitor. O
+// escritor preenche writeBuffer() e chama publish(); o leitor chama update()
+// e lê readBuffer(). Nenhum dos dois espera pelo outro: o escritor sempre
+// tem um buffer livre, e o leitor fica com o último buffer publicado até
+// pedir um novo. Publicações que o leitor não chegou a ver são substituídas.
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() : middle(1), back(0), front(2) {}
+
+    // Escritor
+    T& writeBuffer() { return buffers[back]; }
+
+    // Troca o buffer escrito pelo do meio, marcando-o como novo
+    void publish()
+    {
+        back = middle.exchange(static_cast<uint8_t>(back | NEW_DATA), std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Leitor. Retorna true se havia um buffer novo, que passa a ser o de leitura.
+    bool update()
+    {
+        if (!(middle.load(std::memory_order_relaxed) & NEW_DATA))
+            return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    const T& readBuffer() const { return buffers[front]; }
+
+private:
+    // O índice do buffer do meio e o bit de "novo" ficam juntos em um único
+    // atômico, para a troca ser uma operação só.
+    static const uint8_t INDEX_MASK = 3;
+    static const uint8_t NEW_DATA = 4;
+
+    T buffers[3];
+    std::atomic<uint8_t> middle; // Buffer trocado entre os dois lados (com NEW_DATA)
+    uint8_t back;                // Só o escritor usa
+    uint8_t front;               // Só o leitor usa
+
+    TripleBuffer(const TripleBuffer&);
+    TripleBuffer& operator=(const TripleBuffer&);
+};
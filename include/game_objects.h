@@ -18,6 +18,17 @@ struct GameBall {
     };
 
 
+// Dados "frios" de uma bola, usados somente na renderização. O estado físico
+// (posição, velocidade, orientação) fica no BallState do PhysicsWorld, no
+// mesmo índice.
+struct BallRenderInfo {
+    std::string object_name;
+    int object_id;
+    int texture_unit_index;
+    int shader_object_id;
+};
+
+
 // Estrutura para definir um segmento de reta da tabela
 struct BoundingSegment {
     glm::vec3 p1; // Ponto inicial do segmento
@@ -0,0 +1,124 @@
+// Arquivo: BallMotion.cpp
+
+#include "BallMotion.h"
+
+#include <algorithm>
+#include <limits>
+
+// Abaixo disso (m/s) o deslize ou o rolamento é considerado encerrado
+const float BALL_MOTION_EPSILON = 1e-4f;
+
+
+BallTrajectory::BallTrajectory()
+    : p0(0.0f), v0(0.0f), s0(0.0f), slide_accel(0.0f),
+      p1(0.0f), v1(0.0f), roll_accel(0.0f), t_roll(0.0f), t_stop(0.0f)
+{
+}
+
+
+BallTrajectory::BallTrajectory(const glm::vec2& position, const glm::vec2& velocity, const glm::vec2& spin_velocity,
+                               const TableParameters& table)
+    : p0(position), v0(velocity), s0(spin_velocity), slide_accel(0.0f),
+      p1(position), v1(velocity), roll_accel(0.0f), t_roll(0.0f), t_stop(0.0f)
+{
+    const float sliding_decel = table.sliding_friction * table.gravity;
+    const float rolling_decel = table.rolling_friction * table.gravity;
+
+    // Deslize: u = v - s perde 7/2 mu_s g por segundo, sempre na mesma direção
+    glm::vec2 slip = v0 - s0;
+    float slip_speed = glm::length(slip);
+    if (slip_speed > BALL_MOTION_EPSILON)
+    {
+        slide_accel = slip * (-sliding_decel / slip_speed);
+        t_roll = 2.0f * slip_speed / (7.0f * sliding_decel);
+        p1 = p0 + v0 * t_roll + slide_accel * (0.5f * t_roll * t_roll);
+        v1 = v0 + slide_accel * t_roll;
+    }
+
+    // Rolamento até parar
+    float speed = glm::length(v1);
+    if (speed > BALL_MOTION_EPSILON)
+    {
+        roll_accel = v1 * (-rolling_decel / speed);
+        t_stop = t_roll + speed / rolling_decel;
+    }
+    else
+    {
+        v1 = glm::vec2(0.0f);
+        t_stop = t_roll;
+    }
+}
+
+
+BallPhase BallTrajectory::phase(float t) const
+{
+    if (t < t_roll) return BALL_SLIDING;
+    if (t < t_stop) return BALL_ROLLING;
+    return BALL_STOPPED;
+}
+
+
+glm::vec2 BallTrajectory::position(float t) const
+{
+    if (t <= 0.0f)
+        return p0;
+    if (t < t_roll)
+        return p0 + v0 * t + slide_accel * (0.5f * t * t);
+    float tr = std::min(t, t_stop) - t_roll;
+    return p1 + v1 * tr + roll_accel * (0.5f * tr * tr);
+}
+
+
+glm::vec2 BallTrajectory::velocity(float t) const
+{
+    if (t < t_roll)
+        return v0 + slide_accel * std::max(t, 0.0f);
+    if (t < t_stop)
+        return v1 + roll_accel * (t - t_roll);
+    return glm::vec2(0.0f);
+}
+
+
+glm::vec2 BallTrajectory::spinVelocity(float t) const
+{
+    // Enquanto desliza, o atrito que freia v acelera s em 5/2 da mesma taxa
+    if (t < t_roll)
+        return s0 - slide_accel * (2.5f * std::max(t, 0.0f));
+    return velocity(t);
+}
+
+
+glm::vec2 BallTrajectory::acceleration(float t) const
+{
+    if (t < t_roll) return slide_accel;
+    if (t < t_stop) return roll_accel;
+    return glm::vec2(0.0f);
+}
+
+
+glm::vec2 BallTrajectory::spinTravel(float t) const
+{
+    if (t <= 0.0f)
+        return glm::vec2(0.0f);
+    float ts = std::min(t, t_roll);
+    glm::vec2 travel = s0 * ts - slide_accel * (1.25f * ts * ts);
+    if (t > t_roll)
+        travel += position(t) - p1;
+    return travel;
+}
+
+
+float BallTrajectory::nextPhaseChange(float t) const
+{
+    if (t < t_roll) return t_roll;
+    if (t < t_stop) return t_stop;
+    return std::numeric_limits<float>::infinity();
+}
+
+
+BallTrajectory TrajetoriaDaBola(const BallState& balls, size_t i, const TableParameters& table)
+{
+    return BallTrajectory(glm::vec2(balls.px[i], balls.pz[i]),
+                          glm::vec2(balls.vx[i], balls.vz[i]),
+                          balls.spinVelocity(i), table);
+}
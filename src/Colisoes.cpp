@@ -1,214 +1,1051 @@
 // Arquivo: Colisoes.cpp
 
-#include "Colisoes.h"
-#include "game_objects.h"
+#include "PhysicsWorld.h"
+#include "BallMotion.h"
+#include "ThreadPool.h"
 
 #include <glm/glm.hpp>
 #include <glm/gtx/norm.hpp>
-#include <iostream>
 #include <algorithm> // Para glm::clamp
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
 
-// Constantes físicas e da mesa (copiadas da main.cpp para tornar Colisoes.cpp autossuficiente)
-const float BALL_Y_AXIS = -0.2667f;
-const float BALL_VIRTUAL_RADIUS = 0.02625f;
-const float TABLE_WIDTH = 1.0415f;
-const float TABLE_DEPTH = 2.2845f;
-const float TABLE_HALF_WIDTH = TABLE_WIDTH / 2;
-const float TABLE_HALF_DEPTH = TABLE_DEPTH / 2;
-const float GRID_CELL_SIZE = BALL_VIRTUAL_RADIUS * 4.0f;
-const int GRID_COLS = static_cast<int>(TABLE_WIDTH / GRID_CELL_SIZE) + 1;
-const int GRID_ROWS = static_cast<int>(TABLE_DEPTH / GRID_CELL_SIZE) + 1;
-const float FELT_SURFACE_Y_ACTUAL = BALL_Y_AXIS - BALL_VIRTUAL_RADIUS;
-const float GRAVITY = 9.8f;
-const float RESTITUTION_COEFF = 0.8f;
-const float BALL_FRICTION_FACTOR = 0.99f;
-const float VELOCITY_STOP_THRESHOLD = 0.01f;
-const float FIXED_PHYSICS_DELTA_TIME = 1.0f / 120.0f;
-
-
-void updateSpatialGrid(std::vector<GameBall>& balls, std::vector<std::vector<std::vector<size_t>>>& spatialGrid) {
-    spatialGrid.assign(GRID_COLS, std::vector<std::vector<size_t>>(GRID_ROWS));
-    for (size_t i = 0; i < balls.size(); ++i) {
-        if (!balls[i].active) continue;
-        int col = static_cast<int>((balls[i].position.x + TABLE_HALF_WIDTH) / GRID_CELL_SIZE);
-        int row = static_cast<int>((balls[i].position.z + TABLE_HALF_DEPTH) / GRID_CELL_SIZE);
-        col = glm::clamp(col, 0, GRID_COLS - 1);
-        row = glm::clamp(row, 0, GRID_ROWS - 1);
-        spatialGrid[col][row].push_back(i);
-    }
-}
-
-
-void SimularColisoes(
-    float deltaTime,
-    std::vector<GameBall>& balls,
-    std::vector<BoundingSegment>& tableSegments,
-    std::vector<BoundingSegment>& pocketSegments,
-    std::vector<Pocket>& pockets,
-    std::vector<std::vector<std::vector<size_t>>>& spatialGrid,
-    bool& cueBallPositioningMode
-) {
-    static float physics_accumulator = 0.0f;
+// Constantes da simulação. As da mesa (dimensões, gravidade, restituição,
+// atrito) ficam em PhysicsWorld::parameters; as usadas fora da física, em
+// PhysicsWorld.h.
+const float BALL_SLEEP_TIME = 0.5f; // Tempo parada para a bola dormir
+const float RENDER_TELEPORT_DISTANCE = 0.25f; // Saltos maiores que isso não são interpolados
+const float SLEEP_CONTACT_SLOP = 0.0005f; // Penetração tolerada antes de acordar uma bola encostada
+const int CONTACT_SOLVER_ITERATIONS = 10;
+const int CONTACT_POSITION_ITERATIONS = 2;
+const float SUBSTEP_CFL_NUMBER = 0.5f; // Deslocamento máximo por subpasso, em raios
+const int MAX_SUBSTEPS = 16;
+const float GRID_CELL_RADII = 4.0f;    // Lado da célula do grid, em raios da maior bola
+const size_t GRID_MIN_CELLS = 1024;    // Abaixo disso o grid nunca é engrossado
+const size_t GRID_MAX_CELLS_PER_BALL = 4;
+const size_t PARALLEL_MIN_BALLS = 1024;      // Com menos bolas acordadas o subpasso não usa threads
+const size_t PARALLEL_MIN_CHUNK_BALLS = 256; // Menor pedaço de trabalho entregue a uma thread
+const size_t PARALLEL_CHUNKS_PER_THREAD = 4; // Pedaços por thread, para equilibrar a carga
+
+
+PhysicsWorld::PhysicsWorld()
+    : simTime(0.0),
+      narrowphase(EscolherNarrowphase()),
+      broadphase(BROADPHASE_GRID),
+      threadPool(NULL),
+      integrateOrientation(true),
+      fixedTimeStep(FIXED_PHYSICS_DELTA_TIME),
+      fixedSubsteps(0),
+      maxStepsPerFrame(8),
+      maxFrameTime(0.02f),
+      gridCellSize(0.0f),
+      gridCols(0),
+      gridRows(0),
+      sweepMaxRadius(0.0f),
+      physics_accumulator(0.0f),
+      frame_substeps(0),
+      total_substeps(0),
+      frame_dropped_time(0.0f),
+      dropped_time(0.0),
+      pair_tests(0),
+      segment_tests(0)
+{
+}
+
+
+int PhysicsWorld::step(float deltaTime)
+{
     physics_accumulator += deltaTime;
+    resolveOrientations();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int steps = 0;
+    frame_substeps = 0;
+    frame_dropped_time = 0.0f;
+    while (physics_accumulator >= fixedTimeStep)
+    {
+        saveRenderSnapshot();
+        frame_substeps += SimularColisoes();
+        physics_accumulator -= fixedTimeStep;
+        ++steps;
+
+        // Proteção contra a "espiral da morte": depois de um engasgo longo
+        // (janela arrastada, carga de modelo), recuperar todo o atraso faria
+        // este quadro demorar ainda mais. Passado o limite de passos ou de
+        // tempo, os passos inteiros que sobraram são descartados; a fração
+        // restante fica para a interpolação do desenho.
+        bool too_many_steps = maxStepsPerFrame > 0 && steps >= maxStepsPerFrame;
+        bool too_slow = maxFrameTime > 0.0f &&
+            std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count() >= maxFrameTime;
+        if ((too_many_steps || too_slow) && physics_accumulator >= fixedTimeStep)
+        {
+            float remainder = std::fmod(physics_accumulator, fixedTimeStep);
+            frame_dropped_time = physics_accumulator - remainder;
+            dropped_time += frame_dropped_time;
+            physics_accumulator = remainder;
+            break;
+        }
+    }
+    return steps;
+}
+
+
+void PhysicsWorld::saveRenderSnapshot()
+{
+    previous_position.resize(balls.size());
+    previous_rotation.resize(balls.size());
+    for (size_t i = 0; i < balls.size(); ++i)
+    {
+        previous_position[i] = balls.position(i);
+        previous_rotation[i] = balls.rotation[i];
+    }
+}
+
+
+void PhysicsWorld::resolveOrientations()
+{
+    for (size_t i = 0; i < balls.size(); ++i)
+    {
+        if (balls.rotation[i] == glm::vec3(0.0f))
+            continue;
+        // O instantâneo do desenho passa a ser relativo à nova orientação
+        if (i < previous_rotation.size())
+            previous_rotation[i] -= balls.rotation[i];
+        balls.resolveOrientation(i);
+    }
+}
+
+
+glm::vec3 PhysicsWorld::renderPosition(size_t i, float alpha) const
+{
+    glm::vec3 current = balls.position(i);
+    if (i >= previous_position.size())
+        return current;
+    // Bola encaçapada ou reposicionada: desenha direto na posição nova
+    if (glm::distance2(previous_position[i], current) > RENDER_TELEPORT_DISTANCE * RENDER_TELEPORT_DISTANCE)
+        return current;
+    return glm::mix(previous_position[i], current, alpha);
+}
+
+
+glm::quat PhysicsWorld::renderOrientation(size_t i, float alpha) const
+{
+    if (i >= previous_rotation.size())
+        return balls.currentOrientation(i);
+    // Interpola o giro pendente em vez de dois quatérnios: um único
+    // quatérnio por bola e por quadro desenhado.
+    glm::vec3 r = glm::mix(previous_rotation[i], balls.rotation[i], alpha);
+    return glm::normalize(BallState::QuaternioDoGiro(r) * balls.orientation[i]);
+}
+
+
+size_t PhysicsWorld::memoryUsage() const
+{
+    size_t scratch = workChunks.capacity() * sizeof(WorkChunk) + threadHits.capacity() * sizeof(threadHits[0]);
+    for (size_t k = 0; k < workChunks.size(); ++k)
+        scratch += workChunks[k].contacts.capacity() * sizeof(BallContact) +
+                   workChunks[k].events.capacity() * sizeof(PhysicsEvent) +
+                   workChunks[k].woken.capacity() * sizeof(uint32_t);
+    for (size_t t = 0; t < threadHits.size(); ++t)
+        scratch += threadHits[t].capacity() * sizeof(uint32_t);
+
+    return sizeof(*this) + scratch + balls.memoryUsage() + segmentField.memoryUsage() +
+           (tableSegments.capacity() + pocketSegments.capacity()) * sizeof(BoundingSegment) +
+           pockets.capacity() * sizeof(Pocket) +
+           (gridCellStart.capacity() + gridBallIndices.capacity() + awakeBalls.capacity() +
+            sweepOrder.capacity() + islandParent.capacity() + islandStart.capacity() +
+            islandContacts.capacity() + islandBatchStart.capacity()) * sizeof(uint32_t) +
+           (ballCell.capacity() + islandOf.capacity()) * sizeof(int32_t) +
+           sweepMin.capacity() * sizeof(float) +
+           (previous_position.capacity() + previous_rotation.capacity()) * sizeof(glm::vec3) +
+           contacts.capacity() * sizeof(BallContact) +
+           contactCache.capacity() * sizeof(CachedImpulse);
+}
+
+
+void PhysicsWorld::rebuildSegmentField()
+{
+    float max_radius = parameters.ball_radius;
+    for (size_t i = 0; i < balls.size(); ++i)
+        max_radius = std::max(max_radius, balls.radius[i]);
+    segmentField.build(pocketSegments, tableSegments, max_radius);
+}
+
+
+void PhysicsWorld::resetContacts()
+{
+    contactCache.clear();
+    sweepOrder.clear();
+}
+
+
+void PhysicsWorld::updateSpatialGrid() {
+    // 0. Tamanho das células: o vizinho mais distante que pode encostar em
+    // uma bola fica a 2 raios máximos, então células de 4 raios garantem que
+    // basta olhar as 9 células em volta. Em mesas enormes com poucas bolas
+    // a célula cresce, para o grid não ter muito mais células que bolas.
+    float max_radius = 0.0f;
+    size_t num_active = 0;
+    for (size_t i = 0; i < balls.size(); ++i) {
+        if (!balls.active[i]) continue;
+        max_radius = std::max(max_radius, balls.radius[i]);
+        ++num_active;
+    }
+    if (max_radius <= 0.0f)
+        max_radius = parameters.ball_radius;
+    const float area = parameters.width * parameters.depth;
+    const size_t max_cells = std::max(GRID_MIN_CELLS, GRID_MAX_CELLS_PER_BALL * num_active);
+    gridCellSize = std::max(GRID_CELL_RADII * max_radius, std::sqrt(area / static_cast<float>(max_cells)));
+    gridCols = static_cast<int>(parameters.width / gridCellSize) + 1;
+    gridRows = static_cast<int>(parameters.depth / gridCellSize) + 1;
+
+    const float half_width = 0.5f * parameters.width;
+    const float half_depth = 0.5f * parameters.depth;
+    const size_t num_cells = static_cast<size_t>(gridCols) * gridRows;
+    gridCellStart.assign(num_cells + 1, 0);
+    ballCell.resize(balls.size());
+    gridBallIndices.resize(balls.size());
+
+    // 1. Conta quantas bolas caem em cada célula
+    for (size_t i = 0; i < balls.size(); ++i) {
+        if (!balls.active[i]) { ballCell[i] = -1; continue; }
+        int col = static_cast<int>((balls.px[i] + half_width) / gridCellSize);
+        int row = static_cast<int>((balls.pz[i] + half_depth) / gridCellSize);
+        col = glm::clamp(col, 0, gridCols - 1);
+        row = glm::clamp(row, 0, gridRows - 1);
+        ballCell[i] = col * gridRows + row;
+        gridCellStart[ballCell[i] + 1]++;
+    }
+
+    // 2. Soma de prefixos: gridCellStart[c] passa a ser o início da célula c
+    for (size_t c = 0; c < num_cells; ++c)
+        gridCellStart[c + 1] += gridCellStart[c];
+
+    // 3. Espalha os índices, usando gridCellStart[c] como cursor de escrita.
+    // Ao final, cada gridCellStart[c] aponta para o fim da célula c ...
+    for (size_t i = 0; i < balls.size(); ++i) {
+        if (ballCell[i] < 0) continue;
+        gridBallIndices[gridCellStart[ballCell[i]]++] = static_cast<uint32_t>(i);
+    }
+
+    // ... então deslocamos uma posição para recuperar os inícios.
+    for (size_t c = num_cells; c > 0; --c)
+        gridCellStart[c] = gridCellStart[c - 1];
+    gridCellStart[0] = 0;
+}
+
+
+bool BroadphasePorNome(const char* name, BroadphaseType& type)
+{
+    if (std::strcmp(name, "grid") == 0) { type = BROADPHASE_GRID; return true; }
+    if (std::strcmp(name, "sap") == 0)  { type = BROADPHASE_SWEEP_AND_PRUNE; return true; }
+    return false;
+}
+
+
+const char* NomeDaBroadphase(BroadphaseType type)
+{
+    return type == BROADPHASE_SWEEP_AND_PRUNE ? "sap" : "grid";
+}
+
+
+void PhysicsWorld::updateSweepAndPrune()
+{
+    const size_t n = balls.size();
+    if (sweepOrder.size() != n)
+    {
+        // Bolas adicionadas ou removidas: recomeça da ordem dos índices
+        sweepOrder.resize(n);
+        sweepMin.resize(n);
+        for (size_t k = 0; k < n; ++k)
+            sweepOrder[k] = static_cast<uint32_t>(k);
+    }
+
+    const float* axis = parameters.width > parameters.depth ? balls.px.data() : balls.pz.data();
+    const float inactive = std::numeric_limits<float>::infinity();
+    sweepMaxRadius = 0.0f;
+    for (size_t k = 0; k < n; ++k)
+    {
+        const uint32_t i = sweepOrder[k];
+        if (balls.active[i])
+        {
+            sweepMin[k] = axis[i] - balls.radius[i];
+            sweepMaxRadius = std::max(sweepMaxRadius, balls.radius[i]);
+        }
+        else
+        {
+            sweepMin[k] = inactive;
+        }
+    }
 
-    while (physics_accumulator >= FIXED_PHYSICS_DELTA_TIME)
+    // Ordenação por inserção: de um subpasso para o outro as bolas andam no
+    // máximo meio raio, então quase nada sai do lugar e o custo fica perto
+    // de O(n), contra O(n log n) de uma ordenação do zero.
+    for (size_t k = 1; k < n; ++k)
     {
-        updateSpatialGrid(balls, spatialGrid); // Atualiza o grid antes de usar
-        for (size_t i = 0; i < balls.size(); ++i)
+        const float key = sweepMin[k];
+        const uint32_t ball = sweepOrder[k];
+        size_t j = k;
+        for (; j > 0 && sweepMin[j - 1] > key; --j)
         {
-            GameBall& ball_A = balls[i];
-            if (!ball_A.active) continue;
+            sweepMin[j] = sweepMin[j - 1];
+            sweepOrder[j] = sweepOrder[j - 1];
+        }
+        sweepMin[j] = key;
+        sweepOrder[j] = ball;
+    }
+}
+
 
-            ball_A.velocity.y -= GRAVITY * FIXED_PHYSICS_DELTA_TIME;
-            ball_A.position += ball_A.velocity * FIXED_PHYSICS_DELTA_TIME;
-            ball_A.velocity.x *= BALL_FRICTION_FACTOR;
-            ball_A.velocity.z *= BALL_FRICTION_FACTOR;
+// Empurra a bola i para fora do segmento, se houver penetração, e reflete a
+// componente da velocidade na direção da normal do segmento. O giro é
+// espelhado do mesmo jeito, então uma bola que chega rolando sai rolando.
+// Retorna true se a bola quicou no segmento.
+static bool ColidirComSegmento(BallState& balls, size_t i, const BoundingSegment& seg, float restitution)
+{
+    glm::vec2 s = glm::vec2(seg.p2.x - seg.p1.x, seg.p2.z - seg.p1.z);
+    glm::vec2 b = glm::vec2(balls.px[i] - seg.p1.x, balls.pz[i] - seg.p1.z);
+    float t = glm::clamp(glm::dot(b, s) / glm::dot(s, s), 0.0f, 1.0f);
+    glm::vec2 cp = glm::vec2(seg.p1.x, seg.p1.z) + t * s;
+    glm::vec2 n = glm::vec2(balls.px[i], balls.pz[i]) - cp;
+    float d = glm::length(n);
+    if (d < balls.radius[i])
+    {
+        glm::vec2 dir = glm::normalize(n);
+        float pen = balls.radius[i] - d;
+        balls.px[i] += dir.x * pen;
+        balls.pz[i] += dir.y * pen;
+        glm::vec2 v(balls.vx[i], balls.vz[i]);
+        float dot = glm::dot(v, dir);
+        if (dot < 0)
+        {
+            glm::vec2 rv = v - 2.0f * dot * dir;
+            rv *= restitution;
+            balls.vx[i] = rv.x;
+            balls.vz[i] = rv.y;
+            glm::vec2 spin = balls.spinVelocity(i);
+            balls.setSpinVelocity(i, (spin - 2.0f * glm::dot(spin, dir) * dir) * restitution);
+            return true;
+        }
+    }
+    return false;
+}
+
+
+// Chave do par de bolas no cache de contatos (menor índice nos bits altos)
+static uint64_t ChaveDoPar(uint32_t a, uint32_t b)
+{
+    if (a > b) std::swap(a, b);
+    return (static_cast<uint64_t>(a) << 32) | b;
+}
+
+
+// Aplica o impulso P ao longo da normal n (de b para a). As bolas têm a
+// mesma massa, então cada uma recebe o impulso inteiro, com sinais opostos.
+static void AplicarImpulso(BallState& balls, uint32_t a, uint32_t b, const glm::vec3& n, float P)
+{
+    balls.vx[a] += P * n.x; balls.vy[a] += P * n.y; balls.vz[a] += P * n.z;
+    balls.vx[b] -= P * n.x; balls.vy[b] -= P * n.y; balls.vz[b] -= P * n.z;
+}
+
+
+// Raiz da ilha da bola i no union-find, encurtando o caminho pelo meio
+static uint32_t RaizDaIlha(std::vector<uint32_t>& parent, uint32_t i)
+{
+    while (parent[i] != i)
+    {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+
+// Em quantos pedaços dividir os count itens de uma fase do subpasso: um só
+// sem threads ou com poucas bolas; senão alguns por thread, para equilibrar
+// a carga. O número de pedaços não muda o resultado, só o paralelismo.
+size_t PhysicsWorld::chunkCount(size_t count) const
+{
+    if (threadPool == NULL || threadPool->size() <= 1 || count < PARALLEL_MIN_BALLS)
+        return 1;
+    return std::max<size_t>(1, std::min<size_t>(threadPool->size() * PARALLEL_CHUNKS_PER_THREAD,
+                                                 count / PARALLEL_MIN_CHUNK_BALLS));
+}
+
+
+// Divide [0, count) em num_chunks intervalos contíguos e executa
+// work(begin, end, pedaço, thread) para cada um, nas threads do pool
+void PhysicsWorld::runChunks(size_t num_chunks, size_t count,
+                             const std::function<void(size_t, size_t, WorkChunk&, unsigned)>& work)
+{
+    if (workChunks.size() < num_chunks)
+        workChunks.resize(num_chunks);
+    if (num_chunks <= 1)
+    {
+        work(0, count, workChunks[0], 0);
+        return;
+    }
+    threadPool->parallelFor(num_chunks, [&](size_t k, unsigned thread) {
+        work(count * k / num_chunks, count * (k + 1) / num_chunks, workChunks[k], thread);
+    });
+}
 
-            if (glm::length(glm::vec2(ball_A.velocity.x, ball_A.velocity.z)) < VELOCITY_STOP_THRESHOLD)
+
+// Junta a saída dos pedaços, na ordem deles: contatos, bolas acordadas,
+// eventos e contadores. Os pedaços ficam vazios para a próxima fase.
+void PhysicsWorld::mergeChunks(size_t num_chunks)
+{
+    for (size_t k = 0; k < num_chunks; ++k)
+    {
+        WorkChunk& chunk = workChunks[k];
+        if (contacts.empty())
+            contacts.swap(chunk.contacts); // Sem threads: só troca os buffers
+        else
+            contacts.insert(contacts.end(), chunk.contacts.begin(), chunk.contacts.end());
+        for (size_t w = 0; w < chunk.woken.size(); ++w)
+            balls.wake(chunk.woken[w]);
+        for (size_t e = 0; e < chunk.events.size(); ++e)
+            events.push(chunk.events[e]); // Fila cheia: o evento é descartado e contado
+        pair_tests += chunk.pair_tests;
+        segment_tests += chunk.segment_tests;
+
+        chunk.contacts.clear();
+        chunk.woken.clear();
+        chunk.events.clear();
+        chunk.pair_tests = 0;
+        chunk.segment_tests = 0;
+    }
+}
+
+
+void PhysicsWorld::bufferEvent(WorkChunk& chunk, PhysicsEvent::Type type, size_t ball, size_t other) const
+{
+    PhysicsEvent event;
+    event.type = type;
+    event.ball = static_cast<int32_t>(ball);
+    event.other = static_cast<int32_t>(other);
+    event.time = static_cast<float>(simTime);
+    chunk.events.push_back(event);
+}
+
+
+// Integra as bolas awakeBalls[begin .. end-1]. Cada bola só lê e escreve o
+// próprio estado.
+void PhysicsWorld::integrateBalls(size_t begin, size_t end, float dt)
+{
+    float* px = balls.px.data();
+    float* py = balls.py.data();
+    float* pz = balls.pz.data();
+    float* vx = balls.vx.data();
+    float* vy = balls.vy.data();
+    float* vz = balls.vz.data();
+    const float* radius = balls.radius.data();
+    const uint8_t* active = balls.active.data();
+    const bool track_orientation = integrateOrientation;
+    const float gravity = parameters.gravity;
+    const float felt_y = parameters.feltY();
+    const float cushion_restitution = parameters.cushion_restitution;
+
+    for (size_t a = begin; a < end; ++a)
+    {
+        const size_t i = awakeBalls[a];
+        if (!active[i]) continue;
+
+        vy[i] -= gravity * dt;
+        py[i] += vy[i] * dt;
+
+        // No plano da mesa o movimento (deslize, rolamento, parada) tem forma
+        // fechada: o resultado não depende do tamanho do subpasso.
+        if (vx[i] != 0.0f || vz[i] != 0.0f || balls.wx[i] != 0.0f || balls.wz[i] != 0.0f)
+        {
+            BallTrajectory path = TrajetoriaDaBola(balls, i, parameters);
+            glm::vec2 p = path.position(dt);
+            glm::vec2 v = path.velocity(dt);
+            glm::vec2 spin = path.spinVelocity(dt);
+            px[i] = p.x; pz[i] = p.y;
+            vx[i] = v.x; vz[i] = v.y;
+            balls.wx[i] = spin.y / radius[i];
+            balls.wz[i] = -spin.x / radius[i];
+
+            // Só soma o giro; o quatérnio é montado em resolveOrientations()
+            if (track_orientation)
             {
-                ball_A.velocity.x = 0.0f;
-                ball_A.velocity.z = 0.0f;
+                glm::vec2 travel = path.spinTravel(dt);
+                balls.rotation[i] += glm::vec3(travel.y, 0.0f, -travel.x) / radius[i];
             }
+        }
 
-            glm::vec3 linear_velocity_xz = glm::vec3(ball_A.velocity.x, 0.0f, ball_A.velocity.z);
-            float linear_speed_xz = glm::length(linear_velocity_xz);
-            if (linear_speed_xz > VELOCITY_STOP_THRESHOLD)
+        if (py[i] - radius[i] < felt_y)
+        {
+            py[i] = felt_y + radius[i];
+            vy[i] *= -cushion_restitution;
+            if (glm::abs(vy[i]) < VELOCITY_STOP_THRESHOLD)
             {
-                glm::vec3 surface_normal = glm::vec3(0.0f, 1.0f, 0.0f);
-                ball_A.angular_velocity = glm::cross(surface_normal, linear_velocity_xz) / ball_A.radius;
-                glm::quat frame_rotation = glm::angleAxis(glm::length(ball_A.angular_velocity) * FIXED_PHYSICS_DELTA_TIME,
-                                                          glm::normalize(ball_A.angular_velocity));
-                ball_A.orientation = glm::normalize(frame_rotation * ball_A.orientation);
+                vy[i] = 0.0f;
             }
-            else
+        }
+    }
+}
+
+
+// Contatos das bolas awakeBalls[begin .. end-1] pelo grid. Só lê o estado
+// das bolas; o que muda (contatos, bolas a acordar, eventos) vai para chunk.
+void PhysicsWorld::collectContacts(bool any_asleep, size_t begin, size_t end, WorkChunk& chunk, uint32_t* hits)
+{
+    const float* px = balls.px.data();
+    const float* py = balls.py.data();
+    const float* pz = balls.pz.data();
+    const float* radius = balls.radius.data();
+    const uint8_t* active = balls.active.data();
+    const uint8_t* asleep = balls.asleep.data();
+    const float half_width = 0.5f * parameters.width;
+    const float half_depth = 0.5f * parameters.depth;
+
+    for (size_t a = begin; a < end; ++a)
+    {
+        const uint32_t i = awakeBalls[a];
+        if (!active[i]) continue;
+
+        int col_A = static_cast<int>((px[i] + half_width) / gridCellSize);
+        int row_A = static_cast<int>((pz[i] + half_depth) / gridCellSize);
+        col_A = glm::clamp(col_A, 0, gridCols - 1);
+        row_A = glm::clamp(row_A, 0, gridRows - 1);
+
+        // Vizinhos nas 9 células em volta da bola. O kernel vetorizado testa
+        // de uma vez todas as bolas de uma célula (distância ao quadrado) e só
+        // as sobreposições viram contatos.
+        for (int dc = -1; dc <= 1; ++dc)
+        for (int dr = -1; dr <= 1; ++dr)
+        {
+            int c = col_A + dc, r = row_A + dr;
+            if (c < 0 || c >= gridCols || r < 0 || r >= gridRows) continue;
+            const int cell = c * gridRows + r;
+            const uint32_t* cell_balls = gridBallIndices.data();
+            uint32_t first = gridCellStart[cell];
+            const uint32_t last = gridCellStart[cell + 1];
+
+            // Sem bolas dormindo, só interessam as de índice maior que i, e as
+            // células estão em ordem crescente de índice.
+            if (!any_asleep)
+                first = static_cast<uint32_t>(std::upper_bound(cell_balls + first, cell_balls + last, i) - cell_balls);
+            if (first >= last) continue;
+
+            chunk.pair_tests += last - first;
+            size_t num_hits = narrowphase(px, py, pz, radius, cell_balls + first, last - first,
+                                          px[i], py[i], pz[i], radius[i], hits);
+            for (size_t h = 0; h < num_hits; ++h)
             {
-                ball_A.angular_velocity = glm::vec3(0.0f);
+                const uint32_t j = cell_balls[first + hits[h]];
+                // Pares de bolas acordadas são tratados pela de menor índice;
+                // uma bola dormindo só é testada pelas acordadas ao seu redor.
+                if (j == i || (!asleep[j] && j < i)) continue;
+                if (!active[j]) continue;
+
+                addContact(i, j, chunk);
             }
+        }
+    }
+}
+
 
-            if (ball_A.position.y - ball_A.radius < FELT_SURFACE_Y_ACTUAL)
+// Contatos pelo sweep-and-prune. Com bolas dormindo, [begin, end) são
+// posições em awakeBalls; com todas acordadas, posições em sweepOrder.
+void PhysicsWorld::collectSweepContacts(bool any_asleep, size_t begin, size_t end, WorkChunk& chunk, uint32_t* hits)
+{
+    const float* px = balls.px.data();
+    const float* py = balls.py.data();
+    const float* pz = balls.pz.data();
+    const float* radius = balls.radius.data();
+    const uint8_t* active = balls.active.data();
+    const uint8_t* asleep = balls.asleep.data();
+    const uint32_t* order = sweepOrder.data();
+    const size_t n = sweepOrder.size();
+    const float* axis = parameters.width > parameters.depth ? px : pz;
+
+    if (any_asleep)
+    {
+        // Com bolas dormindo (a mesa quase parada, o caso comum no jogo),
+        // varrer todas as bolas custaria O(n) mesmo com uma só acordada. Cada
+        // bola acordada procura suas vizinhas por busca binária: um intervalo
+        // que começa antes de p - r - 2 * sweepMaxRadius não chega até ela.
+        for (size_t a = begin; a < end; ++a)
+        {
+            const uint32_t i = awakeBalls[a];
+            if (!active[i]) continue;
+            const size_t first = std::lower_bound(sweepMin.begin(), sweepMin.end(),
+                                                  axis[i] - radius[i] - 2.0f * sweepMaxRadius) - sweepMin.begin();
+            const size_t last = std::upper_bound(sweepMin.begin() + first, sweepMin.end(),
+                                                 axis[i] + radius[i]) - sweepMin.begin();
+            if (first >= last) continue;
+
+            chunk.pair_tests += last - first;
+            size_t num_hits = narrowphase(px, py, pz, radius, order + first, last - first,
+                                          px[i], py[i], pz[i], radius[i], hits);
+            for (size_t h = 0; h < num_hits; ++h)
             {
-                ball_A.position.y = FELT_SURFACE_Y_ACTUAL + ball_A.radius;
-                ball_A.velocity.y *= -RESTITUTION_COEFF;
-                if (glm::abs(ball_A.velocity.y) < VELOCITY_STOP_THRESHOLD)
-                {
-                    ball_A.velocity.y = 0.0f;
-                }
+                const uint32_t j = order[first + hits[h]];
+                // Mesma regra do grid: pares de bolas acordadas pela de menor índice
+                if (j == i || (!asleep[j] && j < i)) continue;
+                addContact(i, j, chunk);
             }
+        }
+        return;
+    }
+
+    // Todas acordadas: uma varredura só, cada par visto uma vez
+    for (size_t k = begin; k < end; ++k)
+    {
+        // Daqui em diante só há bolas inativas
+        if (sweepMin[k] == std::numeric_limits<float>::infinity()) break;
+        const uint32_t i = order[k];
 
-            int col_A = static_cast<int>((ball_A.position.x + TABLE_HALF_WIDTH) / GRID_CELL_SIZE);
-            int row_A = static_cast<int>((ball_A.position.z + TABLE_HALF_DEPTH) / GRID_CELL_SIZE);
-            col_A = glm::clamp(col_A, 0, GRID_COLS - 1);
-            row_A = glm::clamp(row_A, 0, GRID_ROWS - 1);
+        // Candidatas: as bolas seguintes na ordem cujo intervalo começa antes
+        // do fim do intervalo de i. Elas são contíguas em sweepOrder, então
+        // vão direto para o kernel vetorizado.
+        const float max_p = axis[i] + radius[i];
+        size_t last = k + 1;
+        while (last < n && sweepMin[last] <= max_p)
+            ++last;
+        if (last == k + 1) continue;
+
+        chunk.pair_tests += last - k - 1;
+        size_t num_hits = narrowphase(px, py, pz, radius, order + k + 1, last - k - 1,
+                                      px[i], py[i], pz[i], radius[i], hits);
+        for (size_t h = 0; h < num_hits; ++h)
+        {
+            const uint32_t j = order[k + 1 + hits[h]];
+            addContact(std::min(i, j), std::max(i, j), chunk);
+        }
+    }
+}
+
+
+// Monta o contato entre a bola acordada i e a bola j (acordada ou dormindo),
+// se elas se sobrepõem. Uma bola dormindo tocada só acorda em mergeChunks,
+// depois que todos os contatos do subpasso foram encontrados.
+void PhysicsWorld::addContact(uint32_t i, uint32_t j, WorkChunk& chunk)
+{
+    const float* px = balls.px.data();
+    const float* py = balls.py.data();
+    const float* pz = balls.pz.data();
+    const float* vx = balls.vx.data();
+    const float* vy = balls.vy.data();
+    const float* vz = balls.vz.data();
+    const float* radius = balls.radius.data();
+    const uint8_t* asleep = balls.asleep.data();
+
+
+    glm::vec3 d = glm::vec3(px[i] - px[j], py[i] - py[j], pz[i] - pz[j]);
+    float dist = glm::length(d);
+    float sum_r = radius[i] + radius[j];
+    if (!(dist < sum_r)) return;
+    glm::vec3 n = dist > 0.0f ? d / dist : glm::vec3(1.0f, 0.0f, 0.0f);
+
+    if (asleep[j])
+    {
+        // Contato de repouso (bolas encostadas, diferença só de
+        // arredondamento) não acorda a bola; senão duas bolas encostadas
+        // ficariam se acordando para sempre.
+        float approach = -(vx[i] * n.x + vz[i] * n.z);
+        if (approach < VELOCITY_STOP_THRESHOLD && sum_r - dist < SLEEP_CONTACT_SLOP)
+            return;
+        chunk.woken.push_back(j);
+    }
+
+    BallContact contact;
+    contact.a = i;
+    contact.b = j;
+    contact.normal = n;
+    // Velocidade de afastamento desejada: só choques de verdade quicam;
+    // contatos de repouso ficam com restituição zero.
+    float vn = (vx[i] - vx[j]) * n.x + (vy[i] - vy[j]) * n.y + (vz[i] - vz[j]) * n.z;
+    contact.bounce_velocity = vn < -VELOCITY_STOP_THRESHOLD ? -parameters.ball_restitution * vn : 0.0f;
+    if (contact.bounce_velocity > 0.0f)
+        bufferEvent(chunk, PhysicsEvent::BALL_BALL, i, j);
+
+    // Impulso do mesmo par no passo anterior (warm start)
+    contact.impulse = 0.0f;
+    const uint64_t key = ChaveDoPar(i, j);
+    std::vector<CachedImpulse>::const_iterator cached =
+        std::lower_bound(contactCache.begin(), contactCache.end(), key,
+                         [](const CachedImpulse& e, uint64_t k) { return e.key < k; });
+    if (cached != contactCache.end() && cached->key == key)
+        contact.impulse = cached->impulse;
+
+    chunk.contacts.push_back(contact);
+}
+
+
+void PhysicsWorld::solveContacts(size_t num_chunks)
+{
+    if (num_chunks > 1 && contacts.size() >= PARALLEL_MIN_CHUNK_BALLS)
+    {
+        // Ilhas diferentes não têm bolas em comum, então resolvê-las em
+        // paralelo dá, bit a bit, o mesmo que o Gauss-Seidel sobre a lista
+        // inteira: cada bola recebe os mesmos impulsos na mesma ordem.
+        buildIslands(num_chunks);
+        threadPool->parallelFor(islandBatchStart.size() - 1, [this](size_t k, unsigned) {
+            const uint32_t first = islandStart[islandBatchStart[k]];
+            const uint32_t last = islandStart[islandBatchStart[k + 1]];
+            solveContactList(islandContacts.data() + first, last - first);
+        });
+    }
+    else
+    {
+        islandContacts.resize(contacts.size());
+        for (size_t c = 0; c < contacts.size(); ++c)
+            islandContacts[c] = static_cast<uint32_t>(c);
+        solveContactList(islandContacts.data(), islandContacts.size());
+    }
+
+    // Guarda os impulsos para o próximo passo, ordenados pela chave do par
+    contactCache.resize(contacts.size());
+    for (size_t c = 0; c < contacts.size(); ++c)
+    {
+        contactCache[c].key = ChaveDoPar(contacts[c].a, contacts[c].b);
+        contactCache[c].impulse = contacts[c].impulse;
+    }
+    std::sort(contactCache.begin(), contactCache.end(),
+              [](const CachedImpulse& x, const CachedImpulse& y) { return x.key < y.key; });
+}
+
+
+// Agrupa os contatos por ilha (union-find sobre as bolas), mantendo a ordem
+// original dentro de cada ilha, e junta ilhas seguidas em num_batches
+// tarefas com números parecidos de contatos.
+void PhysicsWorld::buildIslands(size_t num_batches)
+{
+    const size_t n = balls.size();
+    if (islandParent.size() != n)
+    {
+        islandParent.resize(n);
+        for (size_t i = 0; i < n; ++i)
+            islandParent[i] = static_cast<uint32_t>(i);
+        islandOf.assign(n, -1);
+    }
+
+    // 1. Une as duas bolas de cada contato; a raiz é a de menor índice
+    for (size_t c = 0; c < contacts.size(); ++c)
+    {
+        uint32_t ra = RaizDaIlha(islandParent, contacts[c].a);
+        uint32_t rb = RaizDaIlha(islandParent, contacts[c].b);
+        if (ra == rb) continue;
+        if (ra > rb) std::swap(ra, rb);
+        islandParent[rb] = ra;
+    }
+
+    // 2. Numera as ilhas na ordem do primeiro contato e conta os contatos
+    // de cada uma; a partir daqui é o mesmo counting sort do grid.
+    islandStart.assign(1, 0);
+    for (size_t c = 0; c < contacts.size(); ++c)
+    {
+        const uint32_t root = RaizDaIlha(islandParent, contacts[c].a);
+        if (islandOf[root] < 0)
+        {
+            islandOf[root] = static_cast<int32_t>(islandStart.size() - 1);
+            islandStart.push_back(0);
+        }
+        islandStart[islandOf[root] + 1]++;
+    }
+    const size_t num_islands = islandStart.size() - 1;
+    for (size_t k = 0; k < num_islands; ++k)
+        islandStart[k + 1] += islandStart[k];
+
+    islandContacts.resize(contacts.size());
+    for (size_t c = 0; c < contacts.size(); ++c)
+        islandContacts[islandStart[islandOf[RaizDaIlha(islandParent, contacts[c].a)]]++] = static_cast<uint32_t>(c);
+    for (size_t k = num_islands; k > 0; --k)
+        islandStart[k] = islandStart[k - 1];
+    islandStart[0] = 0;
+
+    // 3. As raízes são bolas de algum contato: desfazer só essas bolas
+    // deixa o union-find pronto para o próximo subpasso.
+    for (size_t c = 0; c < contacts.size(); ++c)
+    {
+        const uint32_t a = contacts[c].a, b = contacts[c].b;
+        islandOf[a] = -1;
+        islandOf[b] = -1;
+        islandParent[a] = a;
+        islandParent[b] = b;
+    }
+
+    // 4. Tarefas: ilhas seguidas até passar da média de contatos por tarefa.
+    // Uma ilha enorme (rack, aglomerado) fica inteira numa tarefa só.
+    const size_t target = contacts.size() / num_batches + 1;
+    islandBatchStart.assign(1, 0);
+    size_t batch_contacts = 0;
+    for (size_t k = 0; k < num_islands; ++k)
+    {
+        batch_contacts += islandStart[k + 1] - islandStart[k];
+        if (batch_contacts >= target)
+        {
+            islandBatchStart.push_back(static_cast<uint32_t>(k + 1));
+            batch_contacts = 0;
+        }
+    }
+    if (islandBatchStart.back() != num_islands)
+        islandBatchStart.push_back(static_cast<uint32_t>(num_islands));
+}
+
+
+// Resolve os contatos list[0 .. count-1], nessa ordem
+void PhysicsWorld::solveContactList(const uint32_t* list, size_t count)
+{
+    // Warm start: reaplica o impulso acumulado no passo anterior. Em bolas
+    // encostadas (rack, grupos parados) ele já é quase a solução, e as
+    // iterações só corrigem a diferença.
+    for (size_t c = 0; c < count; ++c)
+    {
+        const BallContact& contact = contacts[list[c]];
+        if (contact.impulse != 0.0f)
+            AplicarImpulso(balls, contact.a, contact.b, contact.normal, contact.impulse);
+    }
 
-            for (int dc = -1; dc <= 1; ++dc)
-            for (int dr = -1; dr <= 1; ++dr)
+    // Impulsos sequenciais (Gauss-Seidel) com impulso acumulado por contato.
+    // Cada contato leva a velocidade relativa normal até bounce_velocity; o
+    // acumulado nunca fica negativo (bolas só se empurram), o que permite
+    // desfazer um warm start grande demais.
+    for (int it = 0; it < CONTACT_SOLVER_ITERATIONS; ++it)
+    {
+        for (size_t c = 0; c < count; ++c)
+        {
+            BallContact& contact = contacts[list[c]];
+            const uint32_t a = contact.a, b = contact.b;
+            const glm::vec3& n = contact.normal;
+            float vn = (balls.vx[a] - balls.vx[b]) * n.x
+                     + (balls.vy[a] - balls.vy[b]) * n.y
+                     + (balls.vz[a] - balls.vz[b]) * n.z;
+            // Massas iguais: o impulso P muda vn de 2P
+            float new_impulse = std::max(contact.impulse + 0.5f * (contact.bounce_velocity - vn), 0.0f);
+            float delta = new_impulse - contact.impulse;
+            contact.impulse = new_impulse;
+            if (delta != 0.0f)
+                AplicarImpulso(balls, a, b, n, delta);
+        }
+    }
+
+    // Separa as bolas que continuam se sobrepondo, metade para cada lado
+    for (int it = 0; it < CONTACT_POSITION_ITERATIONS; ++it)
+    {
+        for (size_t c = 0; c < count; ++c)
+        {
+            const uint32_t a = contacts[list[c]].a, b = contacts[list[c]].b;
+            glm::vec3 d = balls.position(a) - balls.position(b);
+            float dist = glm::length(d);
+            float sum_r = balls.radius[a] + balls.radius[b];
+            if (!(dist < sum_r) || dist <= 0.0f) continue;
+            glm::vec3 correction = d * ((sum_r - dist) / (2.0f * dist));
+            balls.px[a] += correction.x; balls.py[a] += correction.y; balls.pz[a] += correction.z;
+            balls.px[b] -= correction.x; balls.py[b] -= correction.y; balls.pz[b] -= correction.z;
+        }
+    }
+}
+
+
+// Tabelas e caçapas das bolas awakeBalls[begin .. end-1]. Cada bola só
+// escreve o próprio estado; eventos e contadores vão para chunk.
+void PhysicsWorld::collideWithTable(size_t begin, size_t end, WorkChunk& chunk)
+{
+    const float* px = balls.px.data();
+    const float* pz = balls.pz.data();
+    const float* radius = balls.radius.data();
+    uint8_t* active = balls.active.data();
+    const float cushion_restitution = parameters.cushion_restitution;
+    const size_t num_pocket_segments = pocketSegments.size();
+    const size_t num_segments = num_pocket_segments + tableSegments.size();
+
+    for (size_t a = begin; a < end; ++a)
+    {
+        const size_t i = awakeBalls[a];
+        if (!active[i]) continue;
+
+        // Tabelas e entradas das caçapas: o campo de distância descarta as
+        // bolas longe de todos os segmentos, e só os segmentos candidatos da
+        // célula passam pelo teste exato (primeiro caçapas, depois tabelas).
+        if (radius[i] > segmentField.maxBallRadius())
+        {
+            chunk.segment_tests += num_segments;
+            for (size_t s = 0; s < num_segments; ++s)
+                if (ColidirComSegmento(balls, i, s < num_pocket_segments ? pocketSegments[s]
+                                                                         : tableSegments[s - num_pocket_segments],
+                                       cushion_restitution))
+                    bufferEvent(chunk, PhysicsEvent::BALL_CUSHION, i, s);
+        }
+        else if (segmentField.mayTouch(px[i], pz[i], radius[i]))
+        {
+            const uint16_t* candidate;
+            const uint16_t* candidates_end;
+            segmentField.candidates(px[i], pz[i], candidate, candidates_end);
+            chunk.segment_tests += candidates_end - candidate;
+            for (; candidate != candidates_end; ++candidate)
             {
-                int c = col_A + dc, r = row_A + dr;
-                if (c >= 0 && c < GRID_COLS && r >= 0 && r < GRID_ROWS)
-                for (size_t j_idx : spatialGrid[c][r])
-                {
-                    if (j_idx <= i) continue;
-                    GameBall& ball_B = balls[j_idx];
-                    if (!ball_B.active) continue;
-
-                    glm::vec3 d = ball_A.position - ball_B.position;
-                    float dist = glm::length(d);
-                    float sum_r = ball_A.radius + ball_B.radius;
-                    if (dist < sum_r)
-                    {
-                        glm::vec3 n = glm::normalize(d);
-                        float penetration = sum_r - dist;
-                        ball_A.position += n * (penetration / 2.0f);
-                        ball_B.position -= n * (penetration / 2.0f);
-
-                        glm::vec3 rel_vel = ball_A.velocity - ball_B.velocity;
-                        float proj = glm::dot(rel_vel, n);
-                        if (proj > 0) continue;
-                        glm::vec3 impulse = (-(1.0f + RESTITUTION_COEFF) * proj / 2.0f) * n;
-                        ball_A.velocity += impulse;
-                        ball_B.velocity -= impulse;
-                    }
-                }
+                const size_t s = *candidate;
+                if (ColidirComSegmento(balls, i, s < num_pocket_segments ? pocketSegments[s]
+                                                                         : tableSegments[s - num_pocket_segments],
+                                       cushion_restitution))
+                    bufferEvent(chunk, PhysicsEvent::BALL_CUSHION, i, s);
             }
-            for (const auto& seg : pocketSegments)
+        }
+
+        for (size_t k = 0; k < pockets.size(); ++k)
+        {
+            float dist = glm::length(balls.position(i) - pockets[k].position);
+            if (dist <= (radius[i] + pockets[k].radius))
             {
-                glm::vec2 s = glm::vec2(seg.p2.x - seg.p1.x, seg.p2.z - seg.p1.z);
-                glm::vec2 b = glm::vec2(ball_A.position.x - seg.p1.x, ball_A.position.z - seg.p1.z);
-                float t = glm::clamp(glm::dot(b, s) / glm::dot(s, s), 0.0f, 1.0f);
-                glm::vec2 cp = glm::vec2(seg.p1.x, seg.p1.z) + t * s;
-                glm::vec2 n = glm::vec2(ball_A.position.x, ball_A.position.z) - cp;
-                float d = glm::length(n);
-                if (d < ball_A.radius)
+                // A lógica do jogo fica sabendo pela fila de eventos
+                if (balls.number[i] == 0)
                 {
-                    glm::vec2 dir = glm::normalize(n);
-                    float pen = ball_A.radius - d;
-                    ball_A.position.x += dir.x * pen;
-                    ball_A.position.z += dir.y * pen;
-                    glm::vec2 v(ball_A.velocity.x, ball_A.velocity.z);
-                    float dot = glm::dot(v, dir);
-                    if (dot < 0)
-                    {
-                        glm::vec2 rv = v - 2.0f * dot * dir;
-                        rv *= RESTITUTION_COEFF;
-                        ball_A.velocity.x = rv.x;
-                        ball_A.velocity.z = rv.y;
-                    }
+                    balls.setPosition(i, glm::vec3(parameters.cue_ball_spot.x, parameters.ball_y, parameters.cue_ball_spot.y));
+                    balls.setVelocity(i, glm::vec3(0.0f));
+                    balls.setSpinVelocity(i, glm::vec2(0.0f));
+                    bufferEvent(chunk, PhysicsEvent::CUE_BALL_POCKETED, i, k);
                 }
-            }
-
-            for (const auto& seg : tableSegments)
-            {
-                glm::vec2 s = glm::vec2(seg.p2.x - seg.p1.x, seg.p2.z - seg.p1.z);
-                glm::vec2 b = glm::vec2(ball_A.position.x - seg.p1.x, ball_A.position.z - seg.p1.z);
-                float t = glm::clamp(glm::dot(b, s) / glm::dot(s, s), 0.0f, 1.0f);
-                glm::vec2 cp = glm::vec2(seg.p1.x, seg.p1.z) + t * s;
-                glm::vec2 n = glm::vec2(ball_A.position.x, ball_A.position.z) - cp;
-                float d = glm::length(n);
-                if (d < ball_A.radius)
+                else
                 {
-                    glm::vec2 dir = glm::normalize(n);
-                    float pen = ball_A.radius - d;
-                    ball_A.position.x += dir.x * pen;
-                    ball_A.position.z += dir.y * pen;
-                    glm::vec2 v(ball_A.velocity.x, ball_A.velocity.z);
-                    float dot = glm::dot(v, dir);
-                    if (dot < 0)
-                    {
-                        glm::vec2 rv = v - 2.0f * dot * dir;
-                        rv *= RESTITUTION_COEFF;
-                        ball_A.velocity.x = rv.x;
-                        ball_A.velocity.z = rv.y;
-                    }
+                    active[i] = 0;
+                    balls.setPosition(i, glm::vec3(POCKETED_BALL_POSITION));
+                    balls.setVelocity(i, glm::vec3(0.0f));
+                    balls.setSpinVelocity(i, glm::vec2(0.0f));
+                    bufferEvent(chunk, PhysicsEvent::BALL_POCKETED, i, k);
                 }
+                break;
             }
+        }
+    }
+}
+
+
+void PhysicsWorld::substep(float dt)
+{
+    simTime += dt; // Eventos deste subpasso levam o instante do fim dele
+
+    // Lista das bolas que serão simuladas neste passo. Percorrer o array de
+    // bytes é barato; se todas estiverem dormindo, o passo termina aqui.
+    awakeBalls.clear();
+    bool any_asleep = false;
+    for (size_t i = 0; i < balls.size(); ++i)
+    {
+        if (!balls.active[i]) continue;
+        if (balls.asleep[i])
+            any_asleep = true;
+        else
+            awakeBalls.push_back(static_cast<uint32_t>(i));
+    }
+    if (awakeBalls.empty())
+    {
+        contactCache.clear();
+        return;
+    }
+
+    if (segmentField.segmentCount() != pocketSegments.size() + tableSegments.size())
+        rebuildSegmentField();
+
+    const size_t num_threads = threadPool != NULL ? threadPool->size() : 1;
+    if (threadHits.size() < num_threads)
+        threadHits.resize(num_threads);
+    for (size_t t = 0; t < num_threads; ++t)
+        if (threadHits[t].size() < balls.size())
+            threadHits[t].resize(balls.size());
+
+    // Todas as fases dividem o trabalho do mesmo jeito. Cada pedaço só
+    // escreve nas próprias bolas e no próprio WorkChunk, e os pedaços são
+    // juntados em ordem, então o resultado não depende das threads.
+    const size_t num_awake = awakeBalls.size();
+    const size_t num_chunks = chunkCount(num_awake);
+
+    // 1. Integração. Bolas acordadas durante o passo só entram na lista no
+    // passo seguinte.
+    runChunks(num_chunks, num_awake, [this, dt](size_t begin, size_t end, WorkChunk&, unsigned) {
+        integrateBalls(begin, end, dt);
+    });
+
+    // 2. Contatos bola-bola, com as posições já integradas. A montagem da
+    // broadphase é serial; a busca é dividida entre as bolas.
+    contacts.clear();
+    if (broadphase == BROADPHASE_SWEEP_AND_PRUNE)
+    {
+        updateSweepAndPrune();
+        runChunks(num_chunks, any_asleep ? num_awake : sweepOrder.size(),
+                  [this, any_asleep](size_t begin, size_t end, WorkChunk& chunk, unsigned thread) {
+            collectSweepContacts(any_asleep, begin, end, chunk, threadHits[thread].data());
+        });
+    }
+    else
+    {
+        updateSpatialGrid();
+        runChunks(num_chunks, num_awake,
+                  [this, any_asleep](size_t begin, size_t end, WorkChunk& chunk, unsigned thread) {
+            collectContacts(any_asleep, begin, end, chunk, threadHits[thread].data());
+        });
+    }
+    mergeChunks(num_chunks);
+    solveContacts(num_chunks);
+
+    // 3. Tabelas e caçapas
+    runChunks(num_chunks, num_awake, [this](size_t begin, size_t end, WorkChunk& chunk, unsigned) {
+        collideWithTable(begin, end, chunk);
+    });
+    mergeChunks(num_chunks);
+}
+
 
-            for (const auto& pocket : pockets)
+int PhysicsWorld::SimularColisoes()
+{
+    // Maior velocidade (no plano XZ) em relação ao raio entre as bolas acordadas
+    float max_rate2 = 0.0f;
+    bool any_awake = false;
+    for (size_t i = 0; i < balls.size(); ++i)
+    {
+        if (!balls.active[i] || balls.asleep[i]) continue;
+        any_awake = true;
+        float speed2 = balls.vx[i] * balls.vx[i] + balls.vz[i] * balls.vz[i];
+        max_rate2 = std::max(max_rate2, speed2 / (balls.radius[i] * balls.radius[i]));
+    }
+    if (!any_awake)
+    {
+        contactCache.clear();
+        simTime += fixedTimeStep;
+        return 0; // Mesa parada: nenhum subpasso
+    }
+
+    // Condição CFL: em um subpasso nenhuma bola anda mais que
+    // SUBSTEP_CFL_NUMBER raios. Tacadas fortes ganham subpassos finos, bolas
+    // rolando devagar ficam com um subpasso só.
+    int substeps = fixedSubsteps;
+    if (substeps <= 0)
+    {
+        float travel = glm::sqrt(max_rate2) * fixedTimeStep; // Em raios
+        substeps = glm::clamp(static_cast<int>(std::ceil(travel / SUBSTEP_CFL_NUMBER)), 1, MAX_SUBSTEPS);
+    }
+
+    const float dt = fixedTimeStep / substeps;
+    for (int s = 0; s < substeps; ++s)
+        substep(dt);
+    total_substeps += substeps;
+
+    // Contagem para dormir, uma vez por passo fixo. vy nunca zera por causa
+    // da gravidade e do quique no feltro, então só o movimento no plano XZ
+    // conta (velocidade e giro, que zeram exatamente quando a bola para).
+    const int sleep_steps = std::max(1, static_cast<int>(BALL_SLEEP_TIME / fixedTimeStep + 0.5f));
+    for (size_t a = 0; a < awakeBalls.size(); ++a)
+    {
+        const size_t i = awakeBalls[a];
+        if (balls.active[i] && balls.vx[i] == 0.0f && balls.vz[i] == 0.0f &&
+            balls.wx[i] == 0.0f && balls.wz[i] == 0.0f)
+        {
+            if (++balls.still_steps[i] >= sleep_steps)
             {
-                float dist = glm::length(ball_A.position - pocket.position);
-                if (dist <= (ball_A.radius + pocket.radius))
-                {
-                    if (ball_A.texture_unit_index == 0)
-                    {
-                        cueBallPositioningMode = true;
-                        ball_A.position = glm::vec3(-0.0020f, BALL_Y_AXIS, 0.5680f);
-                        ball_A.velocity = glm::vec3(0.0f);
-                        std::cout << "DEBUG: Bola branca encacapada!\n";
-                    }
-                    else
-                    {
-                        ball_A.active = false;
-                        ball_A.position = glm::vec3(1000.0f);
-                        ball_A.velocity = glm::vec3(0.0f);
-                        std::cout << "DEBUG: Bola encacapada! Pos: ("
-                                  << ball_A.position.x << ", "
-                                  << ball_A.position.y << ", "
-                                  << ball_A.position.z << ")\n";
-                    }
-                    break;
-                }
+                balls.asleep[i] = 1;
+                balls.vy[i] = 0.0f;
+                balls.py[i] = parameters.feltY() + balls.radius[i];
             }
         }
-
-        physics_accumulator -= FIXED_PHYSICS_DELTA_TIME;
+        else
+        {
+            balls.still_steps[i] = 0;
+        }
     }
+    return substeps;
 }
@@ -0,0 +1,139 @@
+// Arquivo: DistanceField.cpp
+
+#include "DistanceField.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <glm/glm.hpp>
+
+// Lado de uma célula do campo. Com 2 cm o campo da mesa padrão tem uns 30 KB.
+const float DISTANCE_FIELD_CELL_SIZE = 0.02f;
+
+
+// Distância do ponto (x, z) ao segmento, no plano XZ
+static float DistanciaAoSegmento(float x, float z, const BoundingSegment& seg)
+{
+    glm::vec2 s = glm::vec2(seg.p2.x - seg.p1.x, seg.p2.z - seg.p1.z);
+    glm::vec2 b = glm::vec2(x - seg.p1.x, z - seg.p1.z);
+    float len2 = glm::dot(s, s);
+    float t = len2 > 0.0f ? glm::clamp(glm::dot(b, s) / len2, 0.0f, 1.0f) : 0.0f;
+    return glm::length(b - t * s);
+}
+
+
+SegmentDistanceField::SegmentDistanceField()
+    : min_x(0.0f), min_z(0.0f), cell_size(DISTANCE_FIELD_CELL_SIZE),
+      max_radius(0.0f), contact_margin(0.0f), cols(0), rows(0), num_segments(0)
+{
+}
+
+
+void SegmentDistanceField::build(const std::vector<BoundingSegment>& pocketSegments,
+                                 const std::vector<BoundingSegment>& tableSegments,
+                                 float max_ball_radius)
+{
+    std::vector<BoundingSegment> segments(pocketSegments);
+    segments.insert(segments.end(), tableSegments.begin(), tableSegments.end());
+
+    num_segments = segments.size();
+    max_radius = max_ball_radius;
+    cell_size = DISTANCE_FIELD_CELL_SIZE;
+    contact_margin = cell_size * glm::sqrt(2.0f);
+    distance.clear();
+    cellStart.clear();
+    cellSegments.clear();
+    cols = rows = 0;
+    if (segments.empty())
+        return;
+
+    // Uma bola encosta em um segmento a menos de max_radius dele, e depois de
+    // ser empurrada por um segmento (no máximo max_radius) ainda pode encostar
+    // em outro. Fora de 2 * max_radius de todos os segmentos não há contato.
+    const float reach = 2.0f * max_radius + contact_margin;
+
+    float max_x = -FLT_MAX, max_z = -FLT_MAX;
+    min_x = FLT_MAX; min_z = FLT_MAX;
+    for (size_t s = 0; s < segments.size(); ++s)
+    {
+        min_x = std::min(min_x, std::min(segments[s].p1.x, segments[s].p2.x));
+        max_x = std::max(max_x, std::max(segments[s].p1.x, segments[s].p2.x));
+        min_z = std::min(min_z, std::min(segments[s].p1.z, segments[s].p2.z));
+        max_z = std::max(max_z, std::max(segments[s].p1.z, segments[s].p2.z));
+    }
+    min_x -= reach; min_z -= reach;
+    max_x += reach; max_z += reach;
+    cols = static_cast<int>((max_x - min_x) / cell_size) + 1;
+    rows = static_cast<int>((max_z - min_z) / cell_size) + 1;
+
+    // Distância nos vértices
+    distance.resize(static_cast<size_t>(cols + 1) * (rows + 1));
+    for (int c = 0; c <= cols; ++c)
+    for (int r = 0; r <= rows; ++r)
+    {
+        float x = min_x + c * cell_size;
+        float z = min_z + r * cell_size;
+        float d = FLT_MAX;
+        for (size_t s = 0; s < segments.size(); ++s)
+            d = std::min(d, DistanciaAoSegmento(x, z, segments[s]));
+        distance[static_cast<size_t>(c) * (rows + 1) + r] = d;
+    }
+
+    // Candidatos por célula: segmentos a menos de reach de algum ponto da
+    // célula, medido a partir do centro (meia diagonal = cell_size * sqrt(2) / 2).
+    const float half_diagonal = 0.5f * contact_margin;
+    cellStart.assign(static_cast<size_t>(cols) * rows + 1, 0);
+    for (int c = 0; c < cols; ++c)
+    for (int r = 0; r < rows; ++r)
+    {
+        float x = min_x + (c + 0.5f) * cell_size;
+        float z = min_z + (r + 0.5f) * cell_size;
+        for (size_t s = 0; s < segments.size(); ++s)
+            if (DistanciaAoSegmento(x, z, segments[s]) <= reach + half_diagonal)
+                cellSegments.push_back(static_cast<uint16_t>(s));
+        cellStart[static_cast<size_t>(c) * rows + r + 1] = static_cast<uint32_t>(cellSegments.size());
+    }
+}
+
+
+bool SegmentDistanceField::cellOf(float x, float z, int& col, int& row, float& fx, float& fz) const
+{
+    float gx = (x - min_x) / cell_size;
+    float gz = (z - min_z) / cell_size;
+    if (!(gx >= 0.0f && gz >= 0.0f && gx < cols && gz < rows))
+        return false; // Fora do campo (ou NaN): longe de todos os segmentos
+    col = static_cast<int>(gx);
+    row = static_cast<int>(gz);
+    fx = gx - col;
+    fz = gz - row;
+    return true;
+}
+
+
+bool SegmentDistanceField::mayTouch(float x, float z, float r) const
+{
+    int col, row;
+    float fx, fz;
+    if (!cellOf(x, z, col, row, fx, fz))
+        return false;
+
+    const float* d0 = &distance[static_cast<size_t>(col) * (rows + 1) + row];
+    const float* d1 = d0 + (rows + 1);
+    float d = (1.0f - fx) * ((1.0f - fz) * d0[0] + fz * d0[1])
+            +         fx  * ((1.0f - fz) * d1[0] + fz * d1[1]);
+    return d < r + contact_margin;
+}
+
+
+void SegmentDistanceField::candidates(float x, float z, const uint16_t*& begin, const uint16_t*& end) const
+{
+    int col, row;
+    float fx, fz;
+    if (!cellOf(x, z, col, row, fx, fz))
+    {
+        begin = end = NULL;
+        return;
+    }
+    const size_t cell = static_cast<size_t>(col) * rows + row;
+    begin = cellSegments.data() + cellStart[cell];
+    end   = cellSegments.data() + cellStart[cell + 1];
+}
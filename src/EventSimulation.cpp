@@ -0,0 +1,397 @@
+// Arquivo: EventSimulation.cpp
+
+#include "EventSimulation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <glm/gtc/quaternion.hpp>
+
+// Limite de eventos por simulação, para o caso de colapso inelástico
+// (infinitas colisões em tempo finito num grupo de bolas encostadas).
+const long long MAX_EVENTS_PER_RUN = 1000000;
+
+// Distância (m) a partir da qual o avanço conservador considera o contato
+// alcançado, e número máximo de avanços por previsão. Se o avanço não
+// convergir, o evento vira uma reavaliação no instante alcançado: quem trata
+// o evento confere a distância de novo e, sem contato, só refaz a previsão.
+const float CONTACT_TOLERANCE = 1e-5f;
+const int   MAX_ADVANCE_ITERATIONS = 64;
+
+const float NO_EVENT = std::numeric_limits<float>::infinity();
+
+
+// Avanço conservador: primeiro instante t em [0, window] em que a distância
+// até o contato, gap(t, approaching, max_speed), chega a zero com a bola se
+// aproximando. max_speed é um limite para a velocidade com que a distância
+// diminui de t até o fim do intervalo, então cada avanço de gap / max_speed
+// nunca passa do contato.
+template <typename Gap>
+static float AvancoConservador(const Gap& gap, float window)
+{
+    float t = 0.0f;
+    for (int k = 0; k < MAX_ADVANCE_ITERATIONS; ++k)
+    {
+        bool approaching;
+        float max_speed;
+        float g = gap(t, approaching, max_speed);
+        if (g <= CONTACT_TOLERANCE)
+        {
+            if (approaching) return t;
+            g = CONTACT_TOLERANCE; // Encostada, mas se afastando
+        }
+        if (!(max_speed > 0.0f)) return NO_EVENT;
+        t += g / max_speed;
+        if (t > window) return NO_EVENT;
+    }
+    return t;
+}
+
+static glm::vec2 PontoMaisProximo(const BoundingSegment& seg, const glm::vec2& p)
+{
+    glm::vec2 a(seg.p1.x, seg.p1.z);
+    glm::vec2 s = glm::vec2(seg.p2.x, seg.p2.z) - a;
+    float t = glm::clamp(glm::dot(p - a, s) / glm::dot(s, s), 0.0f, 1.0f);
+    return a + t * s;
+}
+
+
+EventSimulation::EventSimulation(PhysicsWorld& world)
+    : world(world),
+      now(0.0f)
+{
+}
+
+
+glm::vec2 EventSimulation::PositionAt(uint32_t i, float t) const
+{
+    return motion[i].path.position(t - motion[i].t0);
+}
+
+
+glm::vec2 EventSimulation::VelocityAt(uint32_t i, float t) const
+{
+    return motion[i].path.velocity(t - motion[i].t0);
+}
+
+
+glm::vec2 EventSimulation::SpinAt(uint32_t i, float t) const
+{
+    return motion[i].path.spinVelocity(t - motion[i].t0);
+}
+
+
+glm::vec2 EventSimulation::AccelerationAt(uint32_t i, float t) const
+{
+    return motion[i].path.acceleration(t - motion[i].t0);
+}
+
+
+// Instante absoluto da próxima troca de fase da bola i (infinito se parada)
+float EventSimulation::NextPhaseChange(uint32_t i) const
+{
+    return motion[i].t0 + motion[i].path.nextPhaseChange(now - motion[i].t0);
+}
+
+
+void EventSimulation::SetMotion(uint32_t i, const glm::vec2& position, const glm::vec2& velocity, const glm::vec2& spin)
+{
+    Motion& m = motion[i];
+    m.t0 = now;
+    m.path = BallTrajectory(position, velocity, spin, world.parameters);
+    collision_count[i]++;
+}
+
+
+// Gira a bola entre o último evento dela e o instante t. O giro vem da
+// velocidade da superfície integrada (spinTravel), então vale também
+// enquanto a bola desliza.
+void EventSimulation::AdvanceOrientation(uint32_t i, float t)
+{
+    if (!world.integrateOrientation) return;
+    glm::vec2 travel = motion[i].path.spinTravel(t - motion[i].t0);
+    world.balls.rotation[i] += glm::vec3(travel.y, 0.0f, -travel.x) / world.balls.radius[i];
+    world.balls.resolveOrientation(i);
+}
+
+
+void EventSimulation::Push(EventType type, float time, uint32_t a, uint32_t b)
+{
+    Event e;
+    e.time = time;
+    e.type = type;
+    e.a = a;
+    e.b = b;
+    e.count_a = collision_count[a];
+    e.count_b = type == BALL_BALL ? collision_count[b] : 0;
+    queue.push(e);
+}
+
+
+// Prevê os próximos eventos da bola i a partir do instante atual. Cada
+// previsão só olha até a próxima troca de fase das bolas envolvidas; a troca
+// de fase é um evento que refaz a previsão.
+void EventSimulation::Predict(uint32_t i)
+{
+    const BallState& balls = world.balls;
+    if (!balls.active[i]) return;
+
+    const glm::vec2 p = PositionAt(i, now);
+    const glm::vec2 v = VelocityAt(i, now);
+    const glm::vec2 acc = AccelerationAt(i, now);
+    const float r = balls.radius[i];
+    const float end_i = NextPhaseChange(i);
+
+    // Bola-bola: movimento relativo d(t) = d + w t + a t^2 / 2
+    for (uint32_t j = 0; j < balls.size(); ++j)
+    {
+        if (j == i || !balls.active[j]) continue;
+        const float window = std::min(end_i, NextPhaseChange(j)) - now;
+        if (window == NO_EVENT) continue; // As duas paradas
+        const glm::vec2 d = p - PositionAt(j, now);
+        const glm::vec2 w = v - VelocityAt(j, now);
+        const glm::vec2 a = acc - AccelerationAt(j, now);
+        const float sum_r = r + balls.radius[j];
+        const float end_speed = glm::length(w + a * window);
+        float t = AvancoConservador([&](float t, bool& approaching, float& max_speed) {
+            glm::vec2 dt = d + w * t + a * (0.5f * t * t);
+            glm::vec2 wt = w + a * t;
+            approaching = glm::dot(dt, wt) < 0.0f;
+            max_speed = std::max(glm::length(wt), end_speed);
+            return glm::length(dt) - sum_r;
+        }, window);
+        if (t != NO_EVENT)
+            Push(BALL_BALL, now + t, i, j);
+    }
+
+    if (end_i == NO_EVENT)
+        return; // Bola parada: só pode ser atingida por outra bola
+
+    const float window = end_i - now;
+    const float end_speed = glm::length(v + acc * window);
+
+    // Bola-segmento: a bola colide com a "cápsula" de raio r em volta do segmento
+    for (uint32_t s = 0; s < segments.size(); ++s)
+    {
+        const BoundingSegment& seg = segments[s];
+        float t = AvancoConservador([&](float t, bool& approaching, float& max_speed) {
+            glm::vec2 pt = p + v * t + acc * (0.5f * t * t);
+            glm::vec2 vt = v + acc * t;
+            glm::vec2 away = pt - PontoMaisProximo(seg, pt);
+            approaching = glm::dot(vt, away) < 0.0f;
+            max_speed = std::max(glm::length(vt), end_speed);
+            return glm::length(away) - r;
+        }, window);
+        if (t != NO_EVENT)
+            Push(BALL_SEGMENT, now + t, i, s);
+    }
+
+    // Bola-caçapa: o centro da bola entra no círculo de raio r + raio da caçapa
+    for (uint32_t k = 0; k < world.pockets.size(); ++k)
+    {
+        const glm::vec2 center(world.pockets[k].position.x, world.pockets[k].position.z);
+        const float radius = r + world.pockets[k].radius;
+        float t = AvancoConservador([&](float t, bool& approaching, float& max_speed) {
+            glm::vec2 pt = p + v * t + acc * (0.5f * t * t);
+            approaching = true;
+            max_speed = std::max(glm::length(v + acc * t), end_speed);
+            return glm::length(pt - center) - radius;
+        }, window);
+        if (t != NO_EVENT)
+            Push(BALL_POCKET, now + t, i, k);
+    }
+
+    Push(BALL_PHASE, end_i, i, 0);
+}
+
+
+void EventSimulation::Emit(PhysicsEvent::Type type, uint32_t ball, uint32_t other)
+{
+    PhysicsEvent event;
+    event.type = type;
+    event.ball = static_cast<int32_t>(ball);
+    event.other = static_cast<int32_t>(other);
+    event.time = static_cast<float>(world.simTime + now);
+    world.events.push(event);
+}
+
+
+EventStats EventSimulation::run(float max_time)
+{
+    BallState& balls = world.balls;
+    const uint32_t num_balls = static_cast<uint32_t>(balls.size());
+
+    EventStats stats = {0, 0, 0, 0, 0, 0.0f};
+
+    segments = world.tableSegments;
+    segments.insert(segments.end(), world.pocketSegments.begin(), world.pocketSegments.end());
+    queue = std::priority_queue<Event, std::vector<Event>, std::greater<Event> >();
+    motion.assign(num_balls, Motion());
+    collision_count.assign(num_balls, 0);
+    now = 0.0f;
+
+    for (uint32_t i = 0; i < num_balls; ++i)
+        SetMotion(i, glm::vec2(balls.px[i], balls.pz[i]), glm::vec2(balls.vx[i], balls.vz[i]), balls.spinVelocity(i));
+    for (uint32_t i = 0; i < num_balls; ++i)
+        Predict(i);
+
+    while (!queue.empty() && stats.events < MAX_EVENTS_PER_RUN)
+    {
+        Event e = queue.top();
+        if (e.time > max_time) break;
+        queue.pop();
+
+        if (e.count_a != collision_count[e.a] || (e.type == BALL_BALL && e.count_b != collision_count[e.b]))
+        {
+            stats.discarded++;
+            continue;
+        }
+
+        now = e.time;
+        stats.events++;
+        glm::vec2 p = PositionAt(e.a, now);
+        glm::vec2 v = VelocityAt(e.a, now);
+        glm::vec2 spin = SpinAt(e.a, now);
+        AdvanceOrientation(e.a, now);
+
+        switch (e.type)
+        {
+        case BALL_BALL:
+        {
+            glm::vec2 pb = PositionAt(e.b, now);
+            glm::vec2 d = p - pb;
+            float dist = glm::length(d);
+            float sum_r = balls.radius[e.a] + balls.radius[e.b];
+            if (dist - sum_r > CONTACT_TOLERANCE)
+            {
+                // Reavaliação do avanço conservador: ainda sem contato
+                SetMotion(e.a, p, v, spin);
+                Predict(e.a);
+                break;
+            }
+
+            glm::vec2 vb = VelocityAt(e.b, now);
+            glm::vec2 spin_b = SpinAt(e.b, now);
+            AdvanceOrientation(e.b, now);
+            glm::vec2 n = dist > 0.0f ? d / dist : glm::normalize(vb - v);
+            if (dist < sum_r)
+            {
+                // Sobreposição inicial (bolas posicionadas encostadas demais)
+                p += n * ((sum_r - dist) / 2.0f);
+                pb -= n * ((sum_r - dist) / 2.0f);
+            }
+
+            // O choque só troca velocidade linear; o giro de cada bola
+            // continua, e é ele que faz a bola branca seguir ou voltar.
+            // Encostadas e se afastando, as velocidades ficam como estão.
+            float proj = glm::dot(v - vb, n);
+            if (proj < 0.0f)
+            {
+                glm::vec2 impulse = (-(1.0f + world.parameters.ball_restitution) * proj / 2.0f) * n;
+                v += impulse;
+                vb -= impulse;
+                Emit(PhysicsEvent::BALL_BALL, e.a, e.b);
+                stats.ball_ball++;
+            }
+            SetMotion(e.a, p, v, spin);
+            SetMotion(e.b, pb, vb, spin_b);
+            Predict(e.a);
+            Predict(e.b);
+            break;
+        }
+        case BALL_SEGMENT:
+        {
+            glm::vec2 away = p - PontoMaisProximo(segments[e.b], p);
+            float dist = glm::length(away);
+            float r = balls.radius[e.a];
+            if (dist - r > CONTACT_TOLERANCE)
+            {
+                // Reavaliação do avanço conservador: ainda sem contato
+                SetMotion(e.a, p, v, spin);
+                Predict(e.a);
+                break;
+            }
+            glm::vec2 dir = dist > 0.0f ? away / dist : glm::normalize(-v);
+            if (dist < r)
+                p += dir * (r - dist);
+            float dot = glm::dot(v, dir);
+            if (dot < 0.0f)
+            {
+                // Mesmo quique do passo fixo: velocidade e giro espelhados
+                v = (v - 2.0f * dot * dir) * world.parameters.cushion_restitution;
+                spin = (spin - 2.0f * glm::dot(spin, dir) * dir) * world.parameters.cushion_restitution;
+                // Mesma numeração de segmentos do passo fixo: caçapas, depois tabelas
+                const uint32_t num_table = static_cast<uint32_t>(world.tableSegments.size());
+                Emit(PhysicsEvent::BALL_CUSHION, e.a,
+                     e.b < num_table ? static_cast<uint32_t>(world.pocketSegments.size()) + e.b : e.b - num_table);
+                stats.cushion++;
+            }
+            SetMotion(e.a, p, v, spin);
+            Predict(e.a);
+            break;
+        }
+        case BALL_POCKET:
+        {
+            const Pocket& pocket = world.pockets[e.b];
+            if (glm::length(p - glm::vec2(pocket.position.x, pocket.position.z)) >
+                balls.radius[e.a] + pocket.radius + CONTACT_TOLERANCE)
+            {
+                // Reavaliação do avanço conservador: ainda fora da caçapa
+                SetMotion(e.a, p, v, spin);
+                Predict(e.a);
+                break;
+            }
+            if (balls.number[e.a] == 0)
+            {
+                Emit(PhysicsEvent::CUE_BALL_POCKETED, e.a, e.b);
+                SetMotion(e.a, world.parameters.cue_ball_spot, glm::vec2(0.0f), glm::vec2(0.0f));
+                balls.py[e.a] = world.parameters.ball_y;
+                Predict(e.a);
+            }
+            else
+            {
+                Emit(PhysicsEvent::BALL_POCKETED, e.a, e.b);
+                balls.active[e.a] = 0;
+                SetMotion(e.a, glm::vec2(POCKETED_BALL_POSITION), glm::vec2(0.0f), glm::vec2(0.0f));
+                balls.setPosition(e.a, glm::vec3(POCKETED_BALL_POSITION));
+                balls.setVelocity(e.a, glm::vec3(0.0f));
+                balls.setSpinVelocity(e.a, glm::vec2(0.0f));
+            }
+            stats.pocket++;
+            break;
+        }
+        case BALL_PHASE:
+            SetMotion(e.a, p, v, spin);
+            Predict(e.a);
+            break;
+        }
+    }
+
+    // Fila vazia: todas as bolas pararam no último evento. Caso contrário a
+    // simulação foi interrompida pelo limite de tempo (ou de eventos).
+    float end_time = now;
+    if (!queue.empty() && stats.events < MAX_EVENTS_PER_RUN)
+        end_time = max_time;
+    stats.sim_time = end_time;
+    now = end_time;
+    world.simTime += end_time;
+
+    for (uint32_t i = 0; i < num_balls; ++i)
+    {
+        if (!balls.active[i]) continue;
+        AdvanceOrientation(i, end_time);
+        glm::vec2 p = PositionAt(i, end_time);
+        glm::vec2 v = VelocityAt(i, end_time);
+        glm::vec2 spin = SpinAt(i, end_time);
+        balls.px[i] = p.x;
+        balls.pz[i] = p.y;
+        balls.vx[i] = v.x;
+        balls.vy[i] = 0.0f;
+        balls.vz[i] = v.y;
+        balls.wx[i] = spin.y / balls.radius[i];
+        balls.wz[i] = -spin.x / balls.radius[i];
+        if (v.x != 0.0f || v.y != 0.0f || spin.x != 0.0f || spin.y != 0.0f)
+            balls.wake(i); // Ainda em movimento: o passo fixo precisa continuar simulando
+    }
+    return stats;
+}
@@ -0,0 +1,293 @@
+// Arquivo: Mesa.cpp
+
+#include "Mesa.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+// Velocidades da bola branca com força 0% e 100%. As dimensões da mesa ficam
+// em PhysicsWorld::parameters.
+const float g_MinShotPowerMagnitude = 0.50f;
+const float g_MaxShotPowerMagnitude = 12.0f;
+
+
+// Bola branca no seu ponto e as 15 bolas numeradas no rack triangular, com
+// a ponta em parameters.rack_apex (5 linhas: 1, 2, 3, 4 e 5 bolas)
+static void ColocarBolas(PhysicsWorld& world)
+{
+    const TableParameters& table = world.parameters;
+    BallState& balls = world.balls;
+    balls.clear();
+    world.resetContacts();
+
+    const float r = table.ball_radius;
+    balls.add(0, glm::vec3(table.cue_ball_spot.x, table.ball_y, table.cue_ball_spot.y), r);
+
+    const float diameter = 2.0f * r;
+    const float row_z_offset = diameter * glm::sqrt(3.0f) / 2.0f;
+    int ball_id_counter = 1;
+    for (int row = 0; row < 5; ++row)
+    {
+        for (int col = 0; col <= row; ++col)
+        {
+            float current_z = table.rack_apex.y - (float)row * row_z_offset;
+            float current_x = table.rack_apex.x + (float)col * diameter - (float)row * r;
+            balls.add(ball_id_counter, glm::vec3(current_x, table.ball_y, current_z), r);
+            ball_id_counter++;
+        }
+    }
+}
+
+
+void MontarMesaPadrao(PhysicsWorld& world)
+{
+    world.parameters = TableParameters();
+    ColocarBolas(world);
+
+    const float y = world.parameters.ball_y;
+    // Coordenadas do centro da bola encostada em cada tabela
+    const float x_max = 0.52025000f;
+    const float x_min = -0.52125000f;
+    const float z_min = -1.14725000f;
+    const float z_max = 1.13725000f;
+    const float pocket_radius = 0.1f;
+
+    std::vector<BoundingSegment>& tableSegments = world.tableSegments;
+    std::vector<BoundingSegment>& pocketSegments = world.pocketSegments;
+    std::vector<Pocket>& pockets = world.pockets;
+    tableSegments.clear();
+    pocketSegments.clear();
+    pockets.clear();
+
+    // Segmentos das tabelas (coordenadas do centro da bola em contato com a tabela)
+    tableSegments.push_back({glm::vec3(x_max, y, -0.0730f), glm::vec3(x_max, y, -1.0480f)});
+    tableSegments.push_back({glm::vec3(0.4310f, y, z_min), glm::vec3(-0.4400f, y, z_min)});
+    tableSegments.push_back({glm::vec3(x_min, y, -1.0470f), glm::vec3(x_min, y, -0.0730f)});
+    tableSegments.push_back({glm::vec3(x_min, y, 0.0760f), glm::vec3(x_min, y, 1.0490f)});
+    tableSegments.push_back({glm::vec3(-0.4400f, y, z_max), glm::vec3(0.4340f, y, z_max)});
+    tableSegments.push_back({glm::vec3(x_max , y, 1.0520f), glm::vec3(x_max, y, 0.0770f)});
+
+    // Caçapa Superior Esquerda
+    pocketSegments.push_back({glm::vec3(-0.5200f, y, 1.0530f), glm::vec3(-0.5500f, y, 1.0780f)});
+    pocketSegments.push_back({glm::vec3(-0.4400f, y, 1.1480f), glm::vec3(-0.4650f, y, 1.1730f)});
+    // Caçapa Superior Direita
+    pocketSegments.push_back({glm::vec3(0.5200f, y, 1.0520f), glm::vec3(0.5480f, y, 1.0800f)});
+    pocketSegments.push_back({glm::vec3(0.4400f, y, 1.1480f), glm::vec3(0.4600f, y, 1.1700f)});
+    // Caçapa Central Esquerda
+    pocketSegments.push_back({glm::vec3(-0.5540f, y, 0.0600f), glm::vec3(-0.5200f, y, 0.0720f)});
+    pocketSegments.push_back({glm::vec3(-0.5200f, y, -0.0700f), glm::vec3(-0.5460f, y, -0.0620f)});
+    // Caçapa Central Direita
+    pocketSegments.push_back({glm::vec3(0.5180f, y, 0.0740f), glm::vec3(0.5440f, y, 0.0620f)});
+    pocketSegments.push_back({glm::vec3(0.5200f, y, -0.0720f), glm::vec3(0.5480f, y, -0.0600f)});
+    // Caçapa Inferior Esquerda
+    pocketSegments.push_back({glm::vec3(-0.5200f, y, -1.0500f), glm::vec3(-0.5480f, y, -1.0780f)});
+    pocketSegments.push_back({glm::vec3(-0.4400f, y, -1.1480f), glm::vec3(-0.4640f, y, -1.1740f)});
+    // Caçapa Inferior Direita
+    pocketSegments.push_back({glm::vec3(0.4380f, y, -1.1480f), glm::vec3(0.4640f, y, -1.1740f)});
+    pocketSegments.push_back({glm::vec3(0.5200f, y, -1.0540f), glm::vec3(0.5480f, y, -1.0800f)});
+
+    // As 6 caçapas
+    pockets.push_back({glm::vec3(0.5500f, y, 1.1900f), pocket_radius});
+    pockets.push_back({glm::vec3(-0.5500f, y, 1.1900f), pocket_radius});
+    pockets.push_back({glm::vec3(-0.6300f, y, 0.0000f), pocket_radius});
+    pockets.push_back({glm::vec3(0.6300f, y, 0.0000f), pocket_radius});
+    pockets.push_back({glm::vec3(-0.5740f, y, -1.1860f), pocket_radius});
+    pockets.push_back({glm::vec3(0.5700f, y, -1.1860f), pocket_radius});
+
+    world.rebuildSegmentField();
+}
+
+
+bool CarregarMesa(const char* filename, PhysicsWorld& world)
+{
+    std::ifstream file(filename);
+    if (!file)
+    {
+        fprintf(stderr, "ERROR: Cannot open table file \"%s\".\n", filename);
+        return false;
+    }
+
+    // Os segmentos e caçapas são lidos só em (x, z); a altura é a das bolas,
+    // que pode aparecer depois deles no arquivo.
+    TableParameters table;
+    std::vector<glm::vec4> cushions, jaws;
+    std::vector<glm::vec3> holes;
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line))
+    {
+        ++line_number;
+        std::istringstream in(line);
+        std::string keyword;
+        if (!(in >> keyword) || keyword[0] == '#')
+            continue;
+
+        bool ok;
+        glm::vec4 v;
+        if (keyword == "nome")                    ok = static_cast<bool>(in >> table.name);
+        else if (keyword == "largura")            ok = static_cast<bool>(in >> table.width) && table.width > 0.0f;
+        else if (keyword == "comprimento")        ok = static_cast<bool>(in >> table.depth) && table.depth > 0.0f;
+        else if (keyword == "raio_bola")          ok = static_cast<bool>(in >> table.ball_radius) && table.ball_radius > 0.0f;
+        else if (keyword == "altura_bola")        ok = static_cast<bool>(in >> table.ball_y);
+        else if (keyword == "gravidade")          ok = static_cast<bool>(in >> table.gravity) && table.gravity > 0.0f;
+        else if (keyword == "restituicao_bola")   ok = static_cast<bool>(in >> table.ball_restitution) && table.ball_restitution >= 0.0f && table.ball_restitution <= 1.0f;
+        else if (keyword == "restituicao_tabela") ok = static_cast<bool>(in >> table.cushion_restitution) && table.cushion_restitution >= 0.0f && table.cushion_restitution <= 1.0f;
+        else if (keyword == "atrito_deslize")     ok = static_cast<bool>(in >> table.sliding_friction) && table.sliding_friction > 0.0f;
+        else if (keyword == "atrito_rolamento")   ok = static_cast<bool>(in >> table.rolling_friction) && table.rolling_friction > 0.0f;
+        else if (keyword == "bola_branca")        ok = static_cast<bool>(in >> table.cue_ball_spot.x >> table.cue_ball_spot.y);
+        else if (keyword == "rack")               ok = static_cast<bool>(in >> table.rack_apex.x >> table.rack_apex.y);
+        else if (keyword == "tabela" || keyword == "entrada_cacapa")
+        {
+            // Segmento de comprimento zero não tem direção para o quique
+            ok = static_cast<bool>(in >> v.x >> v.y >> v.z >> v.w) && (v.x != v.z || v.y != v.w);
+            (keyword == "tabela" ? cushions : jaws).push_back(v);
+        }
+        else if (keyword == "cacapa")
+        {
+            ok = static_cast<bool>(in >> v.x >> v.y >> v.z) && v.z > 0.0f;
+            holes.push_back(glm::vec3(v));
+        }
+        else ok = false;
+
+        if (!ok)
+        {
+            fprintf(stderr, "ERROR: Invalid line %d in table file \"%s\".\n", line_number, filename);
+            return false;
+        }
+    }
+
+    const float y = table.ball_y;
+    world.parameters = table;
+    world.tableSegments.clear();
+    world.pocketSegments.clear();
+    world.pockets.clear();
+    for (size_t k = 0; k < cushions.size(); ++k)
+        world.tableSegments.push_back({glm::vec3(cushions[k].x, y, cushions[k].y), glm::vec3(cushions[k].z, y, cushions[k].w)});
+    for (size_t k = 0; k < jaws.size(); ++k)
+        world.pocketSegments.push_back({glm::vec3(jaws[k].x, y, jaws[k].y), glm::vec3(jaws[k].z, y, jaws[k].w)});
+    for (size_t k = 0; k < holes.size(); ++k)
+        world.pockets.push_back({glm::vec3(holes[k].x, y, holes[k].y), holes[k].z});
+
+    ColocarBolas(world);
+    world.rebuildSegmentField();
+    return true;
+}
+
+
+void MontarMesaRetangular(PhysicsWorld& world, float width, float depth)
+{
+    TableParameters& table = world.parameters;
+    table.name = "retangular";
+    table.width = width;
+    table.depth = depth;
+    table.cue_ball_spot = glm::vec2(0.0f, 0.25f * depth);
+    table.rack_apex = glm::vec2(0.0f, -0.25f * depth);
+
+    const float y = table.ball_y;
+    const float r = table.ball_radius;
+    const float xb = 0.5f * width - r;  // Centro da bola encostada nas tabelas
+    const float zb = 0.5f * depth - r;
+    const float corner_gap = 0.085f;    // Da quina até o fim da tabela, nas caçapas de canto
+    const float side_gap = 0.065f;      // Meia boca das caçapas do meio
+    const float jaw = 0.028f;           // Comprimento das entradas das caçapas
+    const float corner_offset = 0.03f;  // Centro da caçapa de canto além da quina
+    const float side_offset = 0.1f;     // Centro da caçapa do meio além da tabela
+    // A bola cai quando encosta na caçapa estando no fim da tabela
+    const float corner_radius = glm::length(glm::vec2(corner_gap + corner_offset, corner_offset)) - r;
+    const float side_radius = glm::length(glm::vec2(side_offset, side_gap)) - r;
+
+    world.balls.clear();
+    world.resetContacts();
+    world.tableSegments.clear();
+    world.pocketSegments.clear();
+    world.pockets.clear();
+    for (int sx = -1; sx <= 1; sx += 2)
+    {
+        // Tabelas laterais (duas de cada lado, separadas pela caçapa do meio)
+        for (int sz = -1; sz <= 1; sz += 2)
+            world.tableSegments.push_back({glm::vec3(sx * xb, y, sz * side_gap), glm::vec3(sx * xb, y, sz * (zb - corner_gap))});
+        // Tabelas das cabeceiras
+        world.tableSegments.push_back({glm::vec3(-(xb - corner_gap), y, sx * zb), glm::vec3(xb - corner_gap, y, sx * zb)});
+
+        for (int sz = -1; sz <= 1; sz += 2)
+        {
+            // Entradas da caçapa de canto (sx, sz) e da do meio (sx), lado sz
+            world.pocketSegments.push_back({glm::vec3(sx * xb, y, sz * (zb - corner_gap)),
+                                            glm::vec3(sx * (xb + jaw), y, sz * (zb - corner_gap + jaw))});
+            world.pocketSegments.push_back({glm::vec3(sx * (xb - corner_gap), y, sz * zb),
+                                            glm::vec3(sx * (xb - corner_gap + jaw), y, sz * (zb + jaw))});
+            world.pocketSegments.push_back({glm::vec3(sx * xb, y, sz * side_gap),
+                                            glm::vec3(sx * (xb + jaw), y, sz * (side_gap - 0.4f * jaw))});
+            world.pockets.push_back({glm::vec3(sx * (xb + corner_offset), y, sz * (zb + corner_offset)), corner_radius});
+        }
+        world.pockets.push_back({glm::vec3(sx * (xb + side_offset), y, 0.0f), side_radius});
+    }
+
+    world.rebuildSegmentField();
+}
+
+
+bool CarregarLayoutMesa(const char* filename, PhysicsWorld& world)
+{
+    std::ifstream file(filename);
+    if (!file)
+    {
+        fprintf(stderr, "ERROR: Cannot open layout file \"%s\".\n", filename);
+        return false;
+    }
+
+    BallState loaded;
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line))
+    {
+        ++line_number;
+        std::istringstream in(line);
+        std::string keyword;
+        if (!(in >> keyword) || keyword[0] == '#')
+            continue;
+
+        int number;
+        float x, z;
+        if (keyword != "bola" || !(in >> number >> x >> z))
+        {
+            fprintf(stderr, "ERROR: Invalid line %d in layout file \"%s\".\n", line_number, filename);
+            return false;
+        }
+        loaded.add(number, glm::vec3(x, world.parameters.ball_y, z), world.parameters.ball_radius);
+    }
+
+    world.balls = loaded;
+    world.resetContacts();
+    return true;
+}
+
+
+glm::vec3 VelocidadeDaTacada(float aimingAngle, float powerPercentage)
+{
+    float shot_power_magnitude = g_MinShotPowerMagnitude + (g_MaxShotPowerMagnitude - g_MinShotPowerMagnitude) * (powerPercentage / 100.0f);
+    glm::vec3 shoot_direction = glm::normalize(glm::vec3(glm::sin(aimingAngle), 0.0f, glm::cos(aimingAngle)));
+    return shoot_direction * shot_power_magnitude;
+}
+
+
+float ForcaDaTacada(float speed)
+{
+    return 100.0f * (speed - g_MinShotPowerMagnitude) / (g_MaxShotPowerMagnitude - g_MinShotPowerMagnitude);
+}
+
+
+bool BolasParadas(const BallState& balls)
+{
+    for (size_t i = 0; i < balls.size(); ++i)
+    {
+        if (!balls.active[i]) continue;
+        if (glm::length(glm::vec2(balls.vx[i], balls.vz[i])) >= VELOCITY_STOP_THRESHOLD ||
+            glm::length(balls.spinVelocity(i)) >= VELOCITY_STOP_THRESHOLD)
+            return false;
+    }
+    return true;
+}
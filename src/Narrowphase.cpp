@@ -0,0 +1,156 @@
+// Arquivo: Narrowphase.cpp
+
+#include "Narrowphase.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+#define NARROWPHASE_X86 1
+#include <immintrin.h>
+#endif
+
+// O kernel AVX2 é compilado só para ele com o atributo target, sem exigir
+// -mavx2 no resto do programa; a escolha é feita em tempo de execução.
+#if defined(NARROWPHASE_X86) && defined(__GNUC__)
+#define NARROWPHASE_AVX2 1
+#endif
+
+
+static size_t NarrowphaseEscalar(const float* px, const float* py, const float* pz,
+                                 const float* radius,
+                                 const uint32_t* candidates, size_t count,
+                                 float x, float y, float z, float r,
+                                 uint32_t* hits)
+{
+    size_t num_hits = 0;
+    for (size_t k = 0; k < count; ++k)
+    {
+        const uint32_t j = candidates[k];
+        float dx = px[j] - x, dy = py[j] - y, dz = pz[j] - z;
+        float sum_r = radius[j] + r;
+        if (dx * dx + dy * dy + dz * dz < sum_r * sum_r)
+            hits[num_hits++] = static_cast<uint32_t>(k);
+    }
+    return num_hits;
+}
+
+
+#if defined(NARROWPHASE_X86)
+static size_t NarrowphaseSSE2(const float* px, const float* py, const float* pz,
+                              const float* radius,
+                              const uint32_t* candidates, size_t count,
+                              float x, float y, float z, float r,
+                              uint32_t* hits)
+{
+    const __m128 bx = _mm_set1_ps(x), by = _mm_set1_ps(y), bz = _mm_set1_ps(z), br = _mm_set1_ps(r);
+    size_t num_hits = 0;
+    size_t k = 0;
+    for (; k + 4 <= count; k += 4)
+    {
+        const uint32_t* c = candidates + k;
+        __m128 dx = _mm_sub_ps(_mm_setr_ps(px[c[0]], px[c[1]], px[c[2]], px[c[3]]), bx);
+        __m128 dy = _mm_sub_ps(_mm_setr_ps(py[c[0]], py[c[1]], py[c[2]], py[c[3]]), by);
+        __m128 dz = _mm_sub_ps(_mm_setr_ps(pz[c[0]], pz[c[1]], pz[c[2]], pz[c[3]]), bz);
+        __m128 sum_r = _mm_add_ps(_mm_setr_ps(radius[c[0]], radius[c[1]], radius[c[2]], radius[c[3]]), br);
+        __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        int mask = _mm_movemask_ps(_mm_cmplt_ps(d2, _mm_mul_ps(sum_r, sum_r)));
+        for (int b = 0; mask != 0; ++b, mask >>= 1)
+            if (mask & 1)
+                hits[num_hits++] = static_cast<uint32_t>(k + b);
+    }
+    size_t tail = NarrowphaseEscalar(px, py, pz, radius, candidates + k, count - k, x, y, z, r, hits + num_hits);
+    for (size_t h = num_hits; h < num_hits + tail; ++h)
+        hits[h] += static_cast<uint32_t>(k);
+    return num_hits + tail;
+}
+#endif
+
+
+#if defined(NARROWPHASE_AVX2)
+__attribute__((target("avx2")))
+static size_t NarrowphaseAVX2(const float* px, const float* py, const float* pz,
+                              const float* radius,
+                              const uint32_t* candidates, size_t count,
+                              float x, float y, float z, float r,
+                              uint32_t* hits)
+{
+    const __m256 bx = _mm256_set1_ps(x), by = _mm256_set1_ps(y), bz = _mm256_set1_ps(z), br = _mm256_set1_ps(r);
+    size_t num_hits = 0;
+    size_t k = 0;
+    for (; k + 8 <= count; k += 8)
+    {
+        __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(candidates + k));
+        __m256 dx = _mm256_sub_ps(_mm256_i32gather_ps(px, idx, 4), bx);
+        __m256 dy = _mm256_sub_ps(_mm256_i32gather_ps(py, idx, 4), by);
+        __m256 dz = _mm256_sub_ps(_mm256_i32gather_ps(pz, idx, 4), bz);
+        __m256 sum_r = _mm256_add_ps(_mm256_i32gather_ps(radius, idx, 4), br);
+        __m256 d2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+        int mask = _mm256_movemask_ps(_mm256_cmp_ps(d2, _mm256_mul_ps(sum_r, sum_r), _CMP_LT_OQ));
+        for (int b = 0; mask != 0; ++b, mask >>= 1)
+            if (mask & 1)
+                hits[num_hits++] = static_cast<uint32_t>(k + b);
+    }
+    // Limpa a metade alta dos registradores antes de voltar para código SSE;
+    // sem isso cada instrução SSE seguinte paga a transição de estado.
+    _mm256_zeroupper();
+    for (; k < count; ++k)
+    {
+        const uint32_t j = candidates[k];
+        float dx = px[j] - x, dy = py[j] - y, dz = pz[j] - z;
+        float sum_r = radius[j] + r;
+        if (dx * dx + dy * dy + dz * dz < sum_r * sum_r)
+            hits[num_hits++] = static_cast<uint32_t>(k);
+    }
+    return num_hits;
+}
+
+static bool CpuTemAVX2()
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+
+NarrowphaseKernel EscolherNarrowphase()
+{
+#if defined(NARROWPHASE_AVX2)
+    if (CpuTemAVX2())
+        return NarrowphaseAVX2;
+#endif
+#if defined(NARROWPHASE_X86)
+    return NarrowphaseSSE2; // SSE2 faz parte da base do x86-64
+#else
+    return NarrowphaseEscalar;
+#endif
+}
+
+
+NarrowphaseKernel NarrowphasePorNome(const char* name)
+{
+    if (strcmp(name, "scalar") == 0)
+        return NarrowphaseEscalar;
+#if defined(NARROWPHASE_X86)
+    if (strcmp(name, "sse2") == 0)
+        return NarrowphaseSSE2;
+#endif
+#if defined(NARROWPHASE_AVX2)
+    if (strcmp(name, "avx2") == 0 && CpuTemAVX2())
+        return NarrowphaseAVX2;
+#endif
+    return NULL;
+}
+
+
+const char* NomeDaNarrowphase(NarrowphaseKernel kernel)
+{
+#if defined(NARROWPHASE_AVX2)
+    if (kernel == NarrowphaseAVX2)
+        return "avx2";
+#endif
+#if defined(NARROWPHASE_X86)
+    if (kernel == NarrowphaseSSE2)
+        return "sse2";
+#endif
+    return "scalar";
+}
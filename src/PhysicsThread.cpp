@@ -0,0 +1,159 @@
+// Arquivo: PhysicsThread.cpp
+
+#include "PhysicsThread.h"
+#include "Mesa.h"
+
+#include <algorithm>
+
+
+float BallSnapshot::interpolationAlpha(std::chrono::steady_clock::time_point now) const
+{
+    float elapsed = std::chrono::duration<float>(now - published_at).count();
+    return glm::clamp(alpha + elapsed / fixed_time_step, 0.0f, 1.0f);
+}
+
+
+glm::vec3 BallSnapshot::renderPosition(size_t i, float t) const
+{
+    return glm::mix(previous_position[i], position[i], t);
+}
+
+
+glm::quat BallSnapshot::renderOrientation(size_t i, float t) const
+{
+    return glm::slerp(previous_orientation[i], orientation[i], t);
+}
+
+
+PhysicsThread::PhysicsThread(PhysicsWorld& world)
+    : world(world),
+      quit(false)
+{
+}
+
+
+PhysicsThread::~PhysicsThread()
+{
+    stop();
+}
+
+
+void PhysicsThread::start()
+{
+    if (running())
+        return;
+    publish();
+    quit.store(false);
+    thread = std::thread(&PhysicsThread::run, this);
+}
+
+
+void PhysicsThread::stop()
+{
+    if (!running())
+        return;
+    quit.store(true);
+    thread.join();
+}
+
+
+bool PhysicsThread::setVelocity(size_t ball, const glm::vec3& velocity)
+{
+    PhysicsCommand command;
+    command.type = PhysicsCommand::SET_VELOCITY;
+    command.ball = static_cast<int32_t>(ball);
+    command.value = velocity;
+    return commands.push(command);
+}
+
+
+bool PhysicsThread::setPosition(size_t ball, const glm::vec3& position)
+{
+    PhysicsCommand command;
+    command.type = PhysicsCommand::SET_POSITION;
+    command.ball = static_cast<int32_t>(ball);
+    command.value = position;
+    return commands.push(command);
+}
+
+
+const BallSnapshot& PhysicsThread::latest()
+{
+    snapshots.update();
+    return snapshots.readBuffer();
+}
+
+
+void PhysicsThread::run()
+{
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point last = Clock::now();
+    while (!quit.load(std::memory_order_relaxed))
+    {
+        bool changed = applyCommands();
+
+        Clock::time_point now = Clock::now();
+        float elapsed = std::chrono::duration<float>(now - last).count();
+        last = now;
+        if (world.step(elapsed) > 0 || changed)
+            publish();
+
+        // Dorme até completar o próximo passo fixo
+        float wait = world.fixedTimeStep - world.accumulator();
+        std::this_thread::sleep_until(now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(wait)));
+    }
+}
+
+
+bool PhysicsThread::applyCommands()
+{
+    bool changed = false;
+    PhysicsCommand command;
+    while (commands.pop(command))
+    {
+        const size_t i = static_cast<size_t>(command.ball);
+        if (i >= world.balls.size())
+            continue;
+        switch (command.type)
+        {
+        case PhysicsCommand::SET_VELOCITY:
+            world.balls.setVelocity(i, command.value);
+            break;
+        case PhysicsCommand::SET_POSITION:
+            world.balls.setPosition(i, command.value);
+            world.balls.setVelocity(i, glm::vec3(0.0f));
+            world.balls.setSpinVelocity(i, glm::vec2(0.0f));
+            break;
+        }
+        changed = true;
+    }
+    return changed;
+}
+
+
+void PhysicsThread::publish()
+{
+    BallSnapshot& snapshot = snapshots.writeBuffer();
+    const BallState& balls = world.balls;
+    const size_t n = balls.size();
+    snapshot.previous_position.resize(n);
+    snapshot.position.resize(n);
+    snapshot.previous_orientation.resize(n);
+    snapshot.orientation.resize(n);
+    snapshot.radius.assign(balls.radius.begin(), balls.radius.end());
+    snapshot.active.assign(balls.active.begin(), balls.active.end());
+    for (size_t i = 0; i < n; ++i)
+    {
+        snapshot.previous_position[i] = world.renderPosition(i, 0.0f);
+        snapshot.position[i] = world.renderPosition(i, 1.0f);
+        snapshot.previous_orientation[i] = world.renderOrientation(i, 0.0f);
+        snapshot.orientation[i] = world.renderOrientation(i, 1.0f);
+    }
+    snapshot.alpha = world.interpolationAlpha();
+    snapshot.fixed_time_step = world.fixedTimeStep;
+    snapshot.stopped = BolasParadas(balls);
+    snapshot.sim_time = world.simTime;
+    snapshot.dropped_time = world.droppedTime();
+    snapshot.published_at = std::chrono::steady_clock::now();
+    snapshots.publish();
+}
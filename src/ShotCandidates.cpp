@@ -0,0 +1,337 @@
+// Arquivo: ShotCandidates.cpp
+
+#include "ShotCandidates.h"
+#include "Mesa.h"
+
+#include <glm/gtx/norm.hpp>
+#include <algorithm>
+#include <cmath>
+
+const float CANDIDATE_POCKET_SPEED = 0.4f;  // Velocidade com que a bola deve chegar à caçapa (margem), em m/s
+const float SLIDE_TO_ROLL = 5.0f / 7.0f;    // Fração da velocidade que sobra quando a bola para de deslizar e rola
+const float BANK_PRIOR = 0.5f;              // Tacadas de tabela erram mais que diretas da mesma distância
+const float COMBINATION_PRIOR = 0.35f;
+const int   FALLBACK_ANGLES = 36;           // Grade usada quando não há tacada geométrica
+const int   FALLBACK_POWERS = 2;
+
+
+const char* NomeDoTipoDeTacada(ShotKind kind)
+{
+    switch (kind)
+    {
+    case SHOT_BANK:        return "tabela";
+    case SHOT_COMBINATION: return "combinação";
+    default:               return "direta";
+    }
+}
+
+
+static glm::vec2 PosicaoNoPlano(const BallState& balls, int32_t i)
+{
+    return glm::vec2(balls.px[i], balls.pz[i]);
+}
+
+
+static float Cruz(const glm::vec2& a, const glm::vec2& b)
+{
+    return a.x * b.y - a.y * b.x;
+}
+
+
+// true se os segmentos ab e cd se cruzam
+static bool SegmentosCruzam(const glm::vec2& a, const glm::vec2& b, const glm::vec2& c, const glm::vec2& d)
+{
+    const float d1 = Cruz(b - a, c - a), d2 = Cruz(b - a, d - a);
+    const float d3 = Cruz(d - c, a - c), d4 = Cruz(d - c, b - c);
+    return ((d1 > 0.0f) != (d2 > 0.0f)) && ((d3 > 0.0f) != (d4 > 0.0f));
+}
+
+
+// true se uma bola de raio radius pode ir em linha reta de from até to sem
+// encostar em nenhuma bola ativa além de skip_a, skip_b e skip_c (teste da
+// cápsula do caminho contra o centro de cada bola). Com 16 bolas, percorrer
+// os arrays é mais rápido que consultar um grid.
+static bool CaminhoLivre(const BallState& balls, const glm::vec2& from, const glm::vec2& to, float radius,
+                         int32_t skip_a, int32_t skip_b, int32_t skip_c)
+{
+    const glm::vec2 d = to - from;
+    const float length2 = glm::dot(d, d);
+    for (size_t j = 0; j < balls.size(); ++j)
+    {
+        const int32_t i = static_cast<int32_t>(j);
+        if (!balls.active[j] || i == skip_a || i == skip_b || i == skip_c) continue;
+        const glm::vec2 c(balls.px[j], balls.pz[j]);
+        const float t = length2 > 0.0f ? glm::clamp(glm::dot(c - from, d) / length2, 0.0f, 1.0f) : 0.0f;
+        const float r = radius + balls.radius[j];
+        if (glm::distance2(c, from + t * d) < r * r)
+            return false;
+    }
+    return true;
+}
+
+
+// Distância ao quadrado do ponto p ao segmento ab
+static float DistanciaAoSegmento2(const glm::vec2& p, const glm::vec2& a, const glm::vec2& b)
+{
+    const glm::vec2 d = b - a;
+    const float length2 = glm::dot(d, d);
+    const float t = length2 > 0.0f ? glm::clamp(glm::dot(p - a, d) / length2, 0.0f, 1.0f) : 0.0f;
+    return glm::distance2(p, a + t * d);
+}
+
+
+// true se uma bola de raio radius indo de from até to encosta em algum
+// segmento (como em ColidirComSegmento: centro a menos de um raio)
+static bool CaminhoEncostaEm(const std::vector<BoundingSegment>& segments, const glm::vec2& from, const glm::vec2& to,
+                             float radius, int32_t skip)
+{
+    const float r2 = radius * radius;
+    for (size_t s = 0; s < segments.size(); ++s)
+    {
+        if (static_cast<int32_t>(s) == skip) continue;
+        const glm::vec2 a(segments[s].p1.x, segments[s].p1.z), b(segments[s].p2.x, segments[s].p2.z);
+        if (SegmentosCruzam(from, to, a, b) ||
+            DistanciaAoSegmento2(a, from, to) < r2 || DistanciaAoSegmento2(b, from, to) < r2 ||
+            DistanciaAoSegmento2(from, a, b) < r2 || DistanciaAoSegmento2(to, a, b) < r2)
+            return true;
+    }
+    return false;
+}
+
+
+// true se uma bola de raio radius indo de from até to bate em alguma tabela
+// (exceto skip_cushion) ou entrada de caçapa
+static bool CruzaTabela(const PhysicsWorld& table, const glm::vec2& from, const glm::vec2& to, float radius,
+                        int32_t skip_cushion)
+{
+    return CaminhoEncostaEm(table.tableSegments, from, to, radius, skip_cushion) ||
+           CaminhoEncostaEm(table.pocketSegments, from, to, radius, -1);
+}
+
+
+// Velocidade logo depois de um choque (bola deslizando, sem giro) para a
+// bola percorrer distance e ainda ter end_speed: ela perde 2/7 da
+// velocidade até começar a rolar e depois freia com deceleration.
+static float VelocidadeParaPercorrer(float distance, float end_speed, float deceleration)
+{
+    return std::sqrt(end_speed * end_speed + 2.0f * deceleration * distance) / SLIDE_TO_ROLL;
+}
+
+
+// Velocidade da bola que acerta, no instante do choque, para a bola
+// acertada sair com speed, com o corte cut
+static float VelocidadeDoChoque(float speed, float cut, float restitution)
+{
+    return speed / (std::cos(cut) * 0.5f * (1.0f + restitution));
+}
+
+
+// Mira da bola branca para a bola ball sair na direção de aim_point: a bola
+// fantasma fica encostada em ball, do lado oposto a aim_point. Retorna false
+// se a bola fantasma estiver fora da mesa, se o corte passar de max_cut ou
+// se o caminho da branca estiver bloqueado.
+static bool MirarNaBola(const PhysicsWorld& table, int32_t ball, const glm::vec2& aim_point, float max_cut,
+                        float& angle, float& cut, float& cue_distance)
+{
+    const BallState& balls = table.balls;
+    const glm::vec2 cue = PosicaoNoPlano(balls, 0);
+    const glm::vec2 object = PosicaoNoPlano(balls, ball);
+    const glm::vec2 departure = glm::normalize(aim_point - object);
+    const glm::vec2 ghost = object - (balls.radius[0] + balls.radius[ball]) * departure;
+
+    if (std::fabs(ghost.x) > 0.5f * table.parameters.width || std::fabs(ghost.y) > 0.5f * table.parameters.depth)
+        return false;
+    const glm::vec2 travel = ghost - cue;
+    cue_distance = glm::length(travel);
+    if (cue_distance <= 0.0f)
+        return false;
+    cut = std::acos(glm::clamp(glm::dot(travel / cue_distance, departure), -1.0f, 1.0f));
+    if (cut > max_cut)
+        return false;
+    if (!CaminhoLivre(balls, cue, ghost, balls.radius[0], 0, ball, -1))
+        return false;
+
+    // Mesma convenção de VelocidadeDaTacada: direção (sin, 0, cos)
+    angle = std::atan2(travel.x, travel.y);
+    return true;
+}
+
+
+// Preenche a força da candidata a partir da velocidade inicial da branca.
+// Retorna false se nem a força máxima basta.
+static bool DefinirForca(ShotCandidate& candidate, float cue_speed)
+{
+    float power = ForcaDaTacada(cue_speed);
+    if (power > 100.0f)
+        return false;
+    candidate.shot.power = std::max(power, 0.0f);
+    return true;
+}
+
+
+std::vector<ShotCandidate> GerarCandidatas(const PhysicsWorld& table, const CandidateSettings& settings)
+{
+    std::vector<ShotCandidate> candidates;
+    const BallState& balls = table.balls;
+    if (balls.empty() || balls.number[0] != 0 || !balls.active[0])
+        return candidates;
+
+    const float deceleration = table.parameters.rolling_friction * table.parameters.gravity;
+    const float restitution = table.parameters.ball_restitution;
+    const float cushion_restitution = table.parameters.cushion_restitution;
+    const int32_t num_balls = static_cast<int32_t>(balls.size());
+
+    for (int32_t target = 1; target < num_balls; ++target)
+    {
+        if (!balls.active[target] || balls.number[target] <= 0 || balls.number[target] >= 32 ||
+            !(settings.target_mask & (1u << balls.number[target])))
+            continue;
+        const glm::vec2 object = PosicaoNoPlano(balls, target);
+        const float radius = balls.radius[target];
+
+        for (size_t k = 0; k < table.pockets.size(); ++k)
+        {
+            const glm::vec2 pocket(table.pockets[k].position.x, table.pockets[k].position.z);
+            const float pocket_radius = table.pockets[k].radius;
+
+            ShotCandidate candidate;
+            candidate.target = target;
+            candidate.pocket = static_cast<int32_t>(k);
+            candidate.cushion = -1;
+
+            // Caminho do alvo até a caçapa, comum às diretas e às combinações.
+            // Os caminhos terminam um raio de caçapa antes do centro, onde a
+            // bola já caiu, para não contar a boca da caçapa como obstáculo.
+            const glm::vec2 entry = pocket - pocket_radius * glm::normalize(pocket - object);
+            const bool pocket_path_clear = CaminhoLivre(balls, object, entry, radius, target, 0, -1) &&
+                                           !CruzaTabela(table, object, entry, radius, -1);
+
+            // 1. Direta: branca -> alvo -> caçapa
+            if (pocket_path_clear)
+            {
+                float cue_distance;
+                candidate.kind = SHOT_DIRECT;
+                candidate.ball = target;
+                if (MirarNaBola(table, target, pocket, settings.max_cut_angle,
+                                candidate.shot.angle, candidate.cut_angle, cue_distance))
+                {
+                    const float distance = glm::distance(object, pocket);
+                    const float object_speed = VelocidadeParaPercorrer(distance, CANDIDATE_POCKET_SPEED, deceleration);
+                    const float hit_speed = VelocidadeDoChoque(object_speed, candidate.cut_angle, restitution);
+                    candidate.prior = std::cos(candidate.cut_angle) / ((1.0f + cue_distance) * (1.0f + distance));
+                    if (DefinirForca(candidate, VelocidadeParaPercorrer(cue_distance, hit_speed, deceleration)))
+                        candidates.push_back(candidate);
+                }
+            }
+
+            // 2. Tabela: o alvo mira o reflexo da caçapa na linha onde o
+            // centro da bola encosta na tabela (um raio para dentro)
+            for (size_t s = 0; settings.banks && s < table.tableSegments.size(); ++s)
+            {
+                const BoundingSegment& seg = table.tableSegments[s];
+                glm::vec2 a(seg.p1.x, seg.p1.z), b(seg.p2.x, seg.p2.z);
+                glm::vec2 normal = glm::normalize(glm::vec2(a.y - b.y, b.x - a.x));
+                if (glm::dot(object - a, normal) < 0.0f)
+                    normal = -normal;
+                a += radius * normal;
+                b += radius * normal;
+                const float object_side = glm::dot(object - a, normal);
+                const float pocket_side = glm::dot(pocket - a, normal);
+                // A caçapa precisa estar do mesmo lado da tabela que a bola
+                if (object_side <= 0.0f || pocket_side <= 0.0f)
+                    continue;
+                const glm::vec2 mirrored = pocket - 2.0f * pocket_side * normal;
+                const glm::vec2 bounce = object + (object_side / (object_side + pocket_side)) * (mirrored - object);
+                const float along = glm::dot(bounce - a, b - a) / glm::dot(b - a, b - a);
+                if (along <= 0.0f || along >= 1.0f)
+                    continue;
+                const glm::vec2 bank_entry = pocket - pocket_radius * glm::normalize(pocket - bounce);
+                if (!CaminhoLivre(balls, object, bounce, radius, target, 0, -1) ||
+                    !CaminhoLivre(balls, bounce, bank_entry, radius, target, 0, -1) ||
+                    CruzaTabela(table, object, bounce, radius, static_cast<int32_t>(s)) ||
+                    CruzaTabela(table, bounce, bank_entry, radius, static_cast<int32_t>(s)))
+                    continue;
+
+                float cue_distance;
+                candidate.kind = SHOT_BANK;
+                candidate.ball = target;
+                candidate.cushion = static_cast<int32_t>(s);
+                if (!MirarNaBola(table, target, bounce, settings.max_cut_angle,
+                                 candidate.shot.angle, candidate.cut_angle, cue_distance))
+                    continue;
+                const float to_cushion = glm::distance(object, bounce);
+                const float to_pocket = glm::distance(bounce, pocket);
+                // Depois da tabela a bola já rola: só freia
+                const float after_bank = std::sqrt(CANDIDATE_POCKET_SPEED * CANDIDATE_POCKET_SPEED +
+                                                   2.0f * deceleration * to_pocket);
+                const float object_speed = VelocidadeParaPercorrer(to_cushion, after_bank / cushion_restitution, deceleration);
+                const float hit_speed = VelocidadeDoChoque(object_speed, candidate.cut_angle, restitution);
+                candidate.prior = BANK_PRIOR * std::cos(candidate.cut_angle) /
+                                  ((1.0f + cue_distance) * (1.0f + to_cushion + to_pocket));
+                if (DefinirForca(candidate, VelocidadeParaPercorrer(cue_distance, hit_speed, deceleration)))
+                    candidates.push_back(candidate);
+            }
+            candidate.cushion = -1;
+
+            // 3. Combinação: branca -> first -> alvo -> caçapa
+            if (!settings.combinations || !pocket_path_clear)
+                continue;
+            const glm::vec2 departure = glm::normalize(pocket - object);
+            for (int32_t first = 1; first < num_balls; ++first)
+            {
+                if (first == target || !balls.active[first]) continue;
+                const glm::vec2 first_position = PosicaoNoPlano(balls, first);
+                const glm::vec2 ghost = object - (balls.radius[first] + balls.radius[target]) * departure;
+                const glm::vec2 travel = ghost - first_position;
+                const float travel_length = glm::length(travel);
+                if (travel_length <= 0.0f)
+                    continue;
+                const float second_cut = std::acos(glm::clamp(glm::dot(travel / travel_length, departure), -1.0f, 1.0f));
+                if (second_cut > settings.max_cut_angle ||
+                    !CaminhoLivre(balls, first_position, ghost, balls.radius[first], first, target, 0) ||
+                    CruzaTabela(table, first_position, ghost, balls.radius[first], -1))
+                    continue;
+
+                float cue_distance;
+                candidate.kind = SHOT_COMBINATION;
+                candidate.ball = first;
+                if (!MirarNaBola(table, first, ghost, settings.max_cut_angle,
+                                 candidate.shot.angle, candidate.cut_angle, cue_distance))
+                    continue;
+                const float distance = glm::distance(object, pocket);
+                const float object_speed = VelocidadeParaPercorrer(distance, CANDIDATE_POCKET_SPEED, deceleration);
+                const float first_hit = VelocidadeDoChoque(object_speed, second_cut, restitution);
+                const float first_speed = VelocidadeParaPercorrer(travel_length, first_hit, deceleration);
+                const float hit_speed = VelocidadeDoChoque(first_speed, candidate.cut_angle, restitution);
+                candidate.prior = COMBINATION_PRIOR * std::cos(candidate.cut_angle) * std::cos(second_cut) /
+                                  ((1.0f + cue_distance) * (1.0f + travel_length + distance));
+                if (DefinirForca(candidate, VelocidadeParaPercorrer(cue_distance, hit_speed, deceleration)))
+                    candidates.push_back(candidate);
+            }
+        }
+    }
+
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const ShotCandidate& x, const ShotCandidate& y) { return x.prior > y.prior; });
+    return candidates;
+}
+
+
+std::vector<ShotOutcome> AvaliarCandidatas(const PhysicsWorld& table, size_t max_candidates,
+                                           const CandidateSettings& candidates, const ShotEvaluation& settings,
+                                           ThreadPool* pool, long long* simulations)
+{
+    std::vector<ShotCandidate> generated = GerarCandidatas(table, candidates);
+    std::vector<ShotParameters> shots;
+    if (generated.empty())
+    {
+        shots = GradeDeTacadas(0.0f, 2.0f * glm::pi<float>(), FALLBACK_ANGLES, 40.0f, 100.0f, FALLBACK_POWERS);
+    }
+    else
+    {
+        generated.resize(std::min(generated.size(), std::max<size_t>(1, max_candidates)));
+        for (size_t c = 0; c < generated.size(); ++c)
+            shots.push_back(generated[c].shot);
+    }
+    return AvaliarTacadas(table, shots, settings, pool, simulations);
+}
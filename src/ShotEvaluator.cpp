@@ -0,0 +1,212 @@
+// Arquivo: ShotEvaluator.cpp
+
+#include "ShotEvaluator.h"
+#include "Mesa.h"
+#include "ThreadPool.h"
+#include "TableState.h"
+#include "TranspositionCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+// Resultado de uma simulação
+struct ShotSample
+{
+    int       potted;
+    uint32_t  potted_mask;
+    bool      scratch;
+    float     sim_time;
+    glm::vec2 cue_position;
+};
+
+
+std::vector<ShotParameters> GradeDeTacadas(float angle_min, float angle_max, int angle_steps,
+                                           float power_min, float power_max, int power_steps)
+{
+    std::vector<ShotParameters> shots;
+    if (angle_steps <= 0 || power_steps <= 0)
+        return shots;
+    shots.reserve(static_cast<size_t>(angle_steps) * power_steps);
+    for (int p = 0; p < power_steps; ++p)
+    {
+        float power = power_steps > 1 ? power_min + (power_max - power_min) * p / (power_steps - 1) : power_min;
+        for (int a = 0; a < angle_steps; ++a)
+        {
+            ShotParameters shot;
+            shot.angle = angle_min + (angle_max - angle_min) * a / angle_steps;
+            shot.power = power;
+            shots.push_back(shot);
+        }
+    }
+    return shots;
+}
+
+
+static uint64_t BitsDoFloat(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// Chave da cache para shot a partir da mesa table_key, com os ajustes que
+// mudam o resultado. A tacada entra com os bits exatos: qualquer diferença
+// muda a simulação.
+static uint64_t ChaveDaTacada(uint64_t table_key, const ShotParameters& shot, const ShotEvaluation& settings)
+{
+    uint64_t key = MisturarChaves(table_key, (BitsDoFloat(shot.angle) << 32) | BitsDoFloat(shot.power));
+    key = MisturarChaves(key, (static_cast<uint64_t>(settings.seed) << 32) | static_cast<uint32_t>(settings.noise_samples));
+    key = MisturarChaves(key, (BitsDoFloat(settings.angle_noise) << 32) | BitsDoFloat(settings.power_noise));
+    key = MisturarChaves(key, (BitsDoFloat(settings.max_time) << 32) | BitsDoFloat(settings.scratch_penalty));
+    return key;
+}
+
+
+// Simula uma tacada em world, a partir do estado de table, até as bolas
+// pararem ou max_time
+static ShotSample SimularTacada(PhysicsWorld& world, const PhysicsWorld& table, const ShotParameters& shot, float max_time)
+{
+    // Atribuir reaproveita os buffers da simulação anterior desta thread
+    world = table;
+    world.threadPool = NULL; // As threads já estão divididas entre as simulações
+    world.integrateOrientation = false;
+    PhysicsEvent event;
+    while (world.events.pop(event)) {}
+
+    world.balls.setVelocity(0, VelocidadeDaTacada(shot.angle, glm::clamp(shot.power, 0.0f, 100.0f)));
+
+    ShotSample sample;
+    sample.potted = 0;
+    sample.potted_mask = 0;
+    sample.scratch = false;
+    const double start = world.simTime;
+    do
+    {
+        world.SimularColisoes();
+        while (world.events.pop(event))
+        {
+            if (event.type == PhysicsEvent::BALL_POCKETED)
+            {
+                ++sample.potted;
+                int number = world.balls.number[event.ball];
+                if (number >= 0 && number < 32)
+                    sample.potted_mask |= 1u << number;
+            }
+            else if (event.type == PhysicsEvent::CUE_BALL_POCKETED)
+            {
+                sample.scratch = true;
+            }
+        }
+    } while (!BolasParadas(world.balls) && world.simTime - start < max_time);
+
+    sample.sim_time = static_cast<float>(world.simTime - start);
+    sample.cue_position = glm::vec2(world.balls.px[0], world.balls.pz[0]);
+    return sample;
+}
+
+
+std::vector<ShotOutcome> AvaliarTacadas(const PhysicsWorld& table, const std::vector<ShotParameters>& shots,
+                                        const ShotEvaluation& settings, ThreadPool* pool, long long* simulations)
+{
+    std::vector<ShotOutcome> outcomes;
+    if (shots.empty() || table.balls.empty() || table.balls.number[0] != 0 || !table.balls.active[0])
+        return outcomes;
+
+    // Tacadas que já estão na cache não são simuladas
+    const size_t num_samples = static_cast<size_t>(std::max(1, settings.noise_samples));
+    outcomes.resize(shots.size());
+    std::vector<uint64_t> keys;
+    std::vector<size_t> pending; // Índices em shots das tacadas a simular
+    TableState state;
+    const bool has_state = table.saveState(state);
+    if (settings.cache != NULL && has_state)
+    {
+        const uint64_t table_key = state.hash();
+        keys.resize(shots.size());
+        for (size_t s = 0; s < shots.size(); ++s)
+        {
+            keys[s] = ChaveDaTacada(table_key, shots[s], settings);
+            if (settings.cache->find(keys[s], outcomes[s]))
+                outcomes[s].shot = shots[s];
+            else
+                pending.push_back(s);
+        }
+    }
+    else
+    {
+        for (size_t s = 0; s < shots.size(); ++s)
+            pending.push_back(s);
+    }
+
+    // As simulações partem do estado salvo, com o relógio zerado, com ou sem
+    // cache: assim o resultado de uma tacada só depende da chave, e um acerto
+    // da cache é exatamente o que a simulação daria
+    PhysicsWorld start = table;
+    if (has_state && !pending.empty())
+    {
+        start.restoreState(state);
+        start.simTime = 0.0;
+    }
+
+    // Uma tarefa por simulação (tacada x amostra de ruído). Cada tarefa tem a
+    // sua semente, que só depende dos bits da tacada e da amostra (não da
+    // posição da tacada em shots), e o seu lugar em samples, então a ordem em
+    // que as threads pegam as tarefas não muda nada.
+    const size_t num_threads = pool != NULL ? pool->size() : 1;
+    std::vector<PhysicsWorld> worlds(pending.empty() ? 0 : num_threads, start);
+    std::vector<ShotSample> samples(pending.size() * num_samples);
+
+    std::function<void(size_t, unsigned)> simulate = [&](size_t task, unsigned thread) {
+        const size_t s = pending[task / num_samples];
+        const size_t sample = task % num_samples;
+        ShotParameters shot = shots[s];
+        if (sample != 0)
+        {
+            const uint64_t shot_bits = (BitsDoFloat(shot.angle) << 32) | BitsDoFloat(shot.power);
+            std::mt19937 rng(static_cast<uint32_t>(MisturarChaves(shot_bits, (static_cast<uint64_t>(settings.seed) << 32) | sample)));
+            std::normal_distribution<float> noise(0.0f, 1.0f);
+            shot.angle += settings.angle_noise * noise(rng);
+            shot.power += settings.power_noise * noise(rng);
+        }
+        samples[task] = SimularTacada(worlds[thread], start, shot, settings.max_time);
+    };
+    if (pool != NULL)
+        pool->parallelFor(samples.size(), simulate);
+    else
+        for (size_t task = 0; task < samples.size(); ++task)
+            simulate(task, 0);
+    if (simulations != NULL)
+        *simulations += static_cast<long long>(samples.size());
+
+    for (size_t p = 0; p < pending.size(); ++p)
+    {
+        const size_t s = pending[p];
+        const ShotSample* shot_samples = &samples[p * num_samples];
+        ShotOutcome& outcome = outcomes[s];
+        outcome.shot = shots[s];
+        outcome.cue_position = shot_samples[0].cue_position;
+        outcome.potted_mask = shot_samples[0].potted_mask;
+        outcome.scratch = shot_samples[0].scratch;
+
+        int potted = 0, scratches = 0;
+        float sim_time = 0.0f;
+        for (size_t k = 0; k < num_samples; ++k)
+        {
+            potted += shot_samples[k].potted;
+            scratches += shot_samples[k].scratch ? 1 : 0;
+            sim_time += shot_samples[k].sim_time;
+        }
+        outcome.potted = static_cast<float>(potted) / num_samples;
+        outcome.scratch_rate = static_cast<float>(scratches) / num_samples;
+        outcome.sim_time = sim_time / num_samples;
+        outcome.score = outcome.potted - settings.scratch_penalty * outcome.scratch_rate;
+        if (!keys.empty())
+            settings.cache->insert(keys[s], outcome);
+    }
+
+    std::stable_sort(outcomes.begin(), outcomes.end(),
+                     [](const ShotOutcome& x, const ShotOutcome& y) { return x.score > y.score; });
+    return outcomes;
+}
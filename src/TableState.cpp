@@ -0,0 +1,116 @@
+// Arquivo: TableState.cpp
+
+#include "TableState.h"
+#include "PhysicsWorld.h"
+
+#include <algorithm>
+#include <cmath>
+
+static int16_t Quantizar(float value, float quantum)
+{
+    long q = std::lround(value / quantum);
+    return static_cast<int16_t>(std::max(-32767L, std::min(32767L, q)));
+}
+
+static float Desquantizar(int16_t value, float quantum)
+{
+    return static_cast<float>(value) * quantum;
+}
+
+
+uint64_t TableState::hash() const
+{
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(this);
+    uint64_t h = 14695981039346656037ull;
+    for (size_t k = 0; k < sizeof(TableState); ++k)
+    {
+        h ^= bytes[k];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+
+bool PhysicsWorld::saveState(TableState& state) const
+{
+    std::memset(&state, 0, sizeof(state));
+    if (balls.size() > static_cast<size_t>(TABLE_STATE_MAX_BALLS))
+        return false;
+
+    state.count = static_cast<uint16_t>(balls.size());
+    for (size_t i = 0; i < balls.size(); ++i)
+    {
+        PackedBall& packed = state.balls[i];
+        packed.still_steps = balls.still_steps[i];
+        packed.number = static_cast<int8_t>(balls.number[i]);
+        packed.flags = (balls.active[i] ? PACKED_BALL_ACTIVE : 0) | (balls.asleep[i] ? PACKED_BALL_ASLEEP : 0);
+        // Bolas encaçapadas ficam com posição e velocidades zeradas
+        if (!balls.active[i])
+            continue;
+
+        packed.position[0] = Quantizar(balls.px[i], TABLE_STATE_POSITION_QUANTUM);
+        packed.position[1] = Quantizar(balls.py[i], TABLE_STATE_POSITION_QUANTUM);
+        packed.position[2] = Quantizar(balls.pz[i], TABLE_STATE_POSITION_QUANTUM);
+        packed.velocity[0] = Quantizar(balls.vx[i], TABLE_STATE_VELOCITY_QUANTUM);
+        packed.velocity[1] = Quantizar(balls.vy[i], TABLE_STATE_VELOCITY_QUANTUM);
+        packed.velocity[2] = Quantizar(balls.vz[i], TABLE_STATE_VELOCITY_QUANTUM);
+        glm::vec2 spin = balls.spinVelocity(i);
+        packed.spin[0] = Quantizar(spin.x, TABLE_STATE_VELOCITY_QUANTUM);
+        packed.spin[1] = Quantizar(spin.y, TABLE_STATE_VELOCITY_QUANTUM);
+
+        // Sem giro pendente a orientação vai como está, para que salvar de
+        // novo um estado restaurado dê os mesmos bytes
+        glm::quat q = balls.rotation[i] == glm::vec3(0.0f) ? balls.orientation[i] : balls.currentOrientation(i);
+        packed.orientation[0] = Quantizar(q.w, 1.0f / TABLE_STATE_ORIENTATION_SCALE);
+        packed.orientation[1] = Quantizar(q.x, 1.0f / TABLE_STATE_ORIENTATION_SCALE);
+        packed.orientation[2] = Quantizar(q.y, 1.0f / TABLE_STATE_ORIENTATION_SCALE);
+        packed.orientation[3] = Quantizar(q.z, 1.0f / TABLE_STATE_ORIENTATION_SCALE);
+    }
+    return true;
+}
+
+
+bool PhysicsWorld::restoreState(const TableState& state)
+{
+    if (state.count != balls.size())
+        return false;
+    for (size_t i = 0; i < balls.size(); ++i)
+        if (state.balls[i].number != balls.number[i])
+            return false;
+
+    for (size_t i = 0; i < balls.size(); ++i)
+    {
+        const PackedBall& packed = state.balls[i];
+        balls.px[i] = Desquantizar(packed.position[0], TABLE_STATE_POSITION_QUANTUM);
+        balls.py[i] = Desquantizar(packed.position[1], TABLE_STATE_POSITION_QUANTUM);
+        balls.pz[i] = Desquantizar(packed.position[2], TABLE_STATE_POSITION_QUANTUM);
+        balls.vx[i] = Desquantizar(packed.velocity[0], TABLE_STATE_VELOCITY_QUANTUM);
+        balls.vy[i] = Desquantizar(packed.velocity[1], TABLE_STATE_VELOCITY_QUANTUM);
+        balls.vz[i] = Desquantizar(packed.velocity[2], TABLE_STATE_VELOCITY_QUANTUM);
+        balls.wx[i] = Desquantizar(packed.spin[1], TABLE_STATE_VELOCITY_QUANTUM) / balls.radius[i];
+        balls.wz[i] = -Desquantizar(packed.spin[0], TABLE_STATE_VELOCITY_QUANTUM) / balls.radius[i];
+        balls.orientation[i] = glm::quat(Desquantizar(packed.orientation[0], 1.0f / TABLE_STATE_ORIENTATION_SCALE),
+                                         Desquantizar(packed.orientation[1], 1.0f / TABLE_STATE_ORIENTATION_SCALE),
+                                         Desquantizar(packed.orientation[2], 1.0f / TABLE_STATE_ORIENTATION_SCALE),
+                                         Desquantizar(packed.orientation[3], 1.0f / TABLE_STATE_ORIENTATION_SCALE));
+        balls.rotation[i] = glm::vec3(0.0f);
+        balls.still_steps[i] = packed.still_steps;
+        balls.active[i] = (packed.flags & PACKED_BALL_ACTIVE) ? 1 : 0;
+        balls.asleep[i] = (packed.flags & PACKED_BALL_ASLEEP) ? 1 : 0;
+        if (!balls.active[i])
+        {
+            balls.px[i] = balls.py[i] = balls.pz[i] = POCKETED_BALL_POSITION;
+            balls.orientation[i] = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+        }
+    }
+
+    // Impulsos do passo anterior e o instantâneo do desenho eram de outro
+    // estado. Nenhum vetor muda de tamanho, então nada é alocado; o
+    // instantâneo só é refeito se já existe (sem step(), nada é desenhado e
+    // renderPosition usa a posição atual).
+    contactCache.clear();
+    physics_accumulator = 0.0f;
+    if (!previous_position.empty())
+        saveRenderSnapshot();
+    return true;
+}
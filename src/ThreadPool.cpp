@@ -0,0 +1,87 @@
+// Arquivo: ThreadPool.cpp
+
+#include "ThreadPool.h"
+
+
+ThreadPool::ThreadPool(unsigned num_threads)
+    : task(NULL),
+      task_count(0),
+      next_task(0),
+      busy(0),
+      generation(0),
+      quit(false)
+{
+    for (unsigned t = 1; t < num_threads; ++t)
+        workers.push_back(std::thread(&ThreadPool::workerLoop, this, t));
+}
+
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    start_cv.notify_all();
+    for (size_t t = 0; t < workers.size(); ++t)
+        workers[t].join();
+}
+
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t, unsigned)>& work)
+{
+    if (workers.empty() || count <= 1)
+    {
+        for (size_t k = 0; k < count; ++k)
+            work(k, 0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = &work;
+        task_count = count;
+        next_task.store(0, std::memory_order_relaxed);
+        busy = static_cast<unsigned>(workers.size());
+        ++generation;
+    }
+    start_cv.notify_all();
+
+    runTasks(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done_cv.wait(lock, [this]() { return busy == 0; });
+    task = NULL;
+}
+
+
+void ThreadPool::workerLoop(unsigned thread)
+{
+    uint64_t seen = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            start_cv.wait(lock, [&]() { return quit || generation != seen; });
+            if (quit)
+                return;
+            seen = generation;
+        }
+
+        runTasks(thread);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busy == 0)
+            done_cv.notify_one();
+    }
+}
+
+
+void ThreadPool::runTasks(unsigned thread)
+{
+    for (size_t k = next_task.fetch_add(1, std::memory_order_relaxed); k < task_count;
+         k = next_task.fetch_add(1, std::memory_order_relaxed))
+    {
+        (*task)(k, thread);
+    }
+}
@@ -0,0 +1,133 @@
+// Arquivo: TranspositionCache.cpp
+
+#include "TranspositionCache.h"
+
+#include <algorithm>
+
+// Finalizador do splitmix64: espalha os bits de x pelos 64 bits da chave
+static uint64_t Espalhar(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+
+uint64_t MisturarChaves(uint64_t a, uint64_t b)
+{
+    return Espalhar(a ^ Espalhar(b));
+}
+
+
+TranspositionCache::TranspositionCache(size_t max_bytes, size_t num_stripes)
+    : stripes(std::max<size_t>(1, num_stripes))
+{
+    numSets = std::max<size_t>(1, max_bytes / (CACHE_WAYS * sizeof(Entry)));
+    entries.resize(numSets * CACHE_WAYS);
+    clockHand.resize(numSets);
+    clear();
+}
+
+
+bool TranspositionCache::find(uint64_t key, ShotOutcome& outcome)
+{
+    const size_t set = setOf(key);
+    Stripe& stripe = stripeOf(set);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    Entry* ways = &entries[set * CACHE_WAYS];
+    for (size_t w = 0; w < CACHE_WAYS; ++w)
+    {
+        if (ways[w].used && ways[w].key == key)
+        {
+            ways[w].referenced = 1;
+            outcome = ways[w].outcome;
+            ++stripe.hits;
+            return true;
+        }
+    }
+    ++stripe.misses;
+    return false;
+}
+
+
+void TranspositionCache::insert(uint64_t key, const ShotOutcome& outcome)
+{
+    const size_t set = setOf(key);
+    Stripe& stripe = stripeOf(set);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    Entry* ways = &entries[set * CACHE_WAYS];
+
+    // Mesma chave ou lugar vazio
+    Entry* victim = NULL;
+    for (size_t w = 0; w < CACHE_WAYS && victim == NULL; ++w)
+        if (ways[w].used && ways[w].key == key)
+            victim = &ways[w];
+    for (size_t w = 0; w < CACHE_WAYS && victim == NULL; ++w)
+        if (!ways[w].used)
+            victim = &ways[w];
+
+    // Relógio: o ponteiro dá uma segunda chance a quem foi usado, apagando o
+    // bit, e para na primeira entrada sem o bit. Em no máximo uma volta e
+    // meia alguém sai.
+    if (victim == NULL)
+    {
+        uint8_t& hand = clockHand[set];
+        while (ways[hand].referenced)
+        {
+            ways[hand].referenced = 0;
+            hand = static_cast<uint8_t>((hand + 1) % CACHE_WAYS);
+        }
+        victim = &ways[hand];
+        hand = static_cast<uint8_t>((hand + 1) % CACHE_WAYS);
+        ++stripe.evictions;
+    }
+
+    victim->key = key;
+    victim->outcome = outcome;
+    victim->used = 1;
+    victim->referenced = 0;
+    ++stripe.insertions;
+}
+
+
+void TranspositionCache::clear()
+{
+    for (size_t s = 0; s < stripes.size(); ++s)
+    {
+        Stripe& stripe = stripes[s];
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        for (size_t set = s; set < numSets; set += stripes.size())
+        {
+            for (size_t w = 0; w < CACHE_WAYS; ++w)
+            {
+                entries[set * CACHE_WAYS + w].used = 0;
+                entries[set * CACHE_WAYS + w].referenced = 0;
+            }
+            clockHand[set] = 0;
+        }
+        stripe.hits = stripe.misses = stripe.insertions = stripe.evictions = 0;
+    }
+}
+
+
+size_t TranspositionCache::memoryUsage() const
+{
+    return entries.capacity() * sizeof(Entry) + clockHand.capacity() * sizeof(uint8_t) +
+           stripes.capacity() * sizeof(Stripe);
+}
+
+
+TranspositionStats TranspositionCache::stats() const
+{
+    TranspositionStats total = {0, 0, 0, 0};
+    for (size_t s = 0; s < stripes.size(); ++s)
+    {
+        std::lock_guard<std::mutex> lock(stripes[s].mutex);
+        total.hits += stripes[s].hits;
+        total.misses += stripes[s].misses;
+        total.insertions += stripes[s].insertions;
+        total.evictions += stripes[s].evictions;
+    }
+    return total;
+}
@@ -38,7 +38,9 @@
 #include "utils.h"
 #include "matrices.h"
 #include "ObjModel.h"
-#include "Colisoes.h"
+#include "PhysicsWorld.h"
+#include "Mesa.h"
+#include "PhysicsThread.h"
 
 
 // Declaração de funções utilizadas para pilha de matrizes de modelagem.
@@ -118,8 +120,20 @@ struct SceneObject
 //     };
 
 
-// Variável global para armazenar todas as bolas do jogo
-std::vector<GameBall> g_Balls;
+// Mundo físico da mesa: bolas, tabelas, caçapas e acumulador de tempo
+PhysicsWorld g_World;
+
+// Variável global para acessar o estado físico de todas as bolas do jogo
+// (guardado em g_World, no formato SoA). Só é usada para montar a mesa:
+// depois que g_Physics começa, o mundo pertence à thread da física.
+BallState& g_Balls = g_World.balls;
+
+// Thread da física. O desenho lê o estado publicado por ela (g_Physics.latest())
+// e o jogo manda tacadas e reposicionamentos pela fila de comandos.
+PhysicsThread g_Physics(g_World);
+
+// Dados de renderização de cada bola, no mesmo índice de g_Balls
+std::vector<BallRenderInfo> g_BallRender;
 
 // Tamanho do passo para o movimento fixo da bola (em unidades do mundo virtual)
 float g_BallStepSize = 0.02f; // <<=== Comece com 0.1. Ajuste este valor conforme sua escala.
@@ -197,61 +211,12 @@ enum CameraMode {
 CameraMode g_CameraMode = BEZIER;
 
 
-// A simple grid structure to store ball indices
-std::vector<std::vector<std::vector<size_t>>> spatialGrid;
-
 bool g_CueBallPositioningMode = false;
+glm::vec3 g_CueBallPlacement;          // Posição escolhida para a bola branca
+bool g_CueBallPlacementValid = false;  // false até a primeira tecla no modo de posicionamento
 
-// Altura fixa em Y para o CENTRO das bolas quando elas estão apoiadas na mesa.
-const float BALL_Y_AXIS = -0.2667f; // Valor fornecido pelo usuário.
-const float BALL_VIRTUAL_RADIUS = 0.02625f;
-
-
-const float TABLE_WIDTH = 1.04150000f ;
-const float TABLE_DEPTH = 2.28450000f ;
-const float TABLE_HALF_WIDTH = TABLE_WIDTH/2;
-const float TABLE_HALF_DEPTH = TABLE_DEPTH/2;
-
-const float GRID_CELL_SIZE = BALL_VIRTUAL_RADIUS * 4.0f; // Example: 4 times ball radius
-const int GRID_COLS = static_cast<int>(TABLE_WIDTH / GRID_CELL_SIZE) + 1;
-const int GRID_ROWS = static_cast<int>(TABLE_DEPTH / GRID_CELL_SIZE) + 1;
-
-// Raio das esferas que representam as caçapas (para visualização e colisão)
-const float POCKET_SPHERE_RADIUS = 0.1f;
-
-
-// Constantes para o posicionamento das bolas no rack triangular
-const float RACK_TIP_Z_COORD = -0.60f; // Posição Z do centro da bola na ponta do triângulo (ajuste conforme necessário)
-const float BALL_DIAMETER = BALL_VIRTUAL_RADIUS * 2.0f; // Diâmetro da bola
-// Distância vertical entre os centros das bolas em linhas adjacentes (para um rack apertado)
-const float RACK_ROW_Z_OFFSET = BALL_DIAMETER * glm::sqrt(3.0f) / 2.0f;
-// Offset horizontal para o início de cada nova linha do rack
-const float RACK_ROW_X_OFFSET = BALL_DIAMETER / 2.0f;
-
-
-const float TABLE_X_MAX_BALL_CENTER = 0.52025000f; // Exemplo de valor obtido
-const float TABLE_X_MIN_BALL_CENTER = -0.52125000f; // Exemplo de valor obtido
-const float TABLE_Z_MIN_BALL_CENTER = -1.14725000f; // Exemplo de valor obtido
-const float TABLE_Z_MAX_BALL_CENTER = 1.13725000f; // Exemplo de valor obtido
-
-
-// A altura da superfície do feltro da mesa será o centro da bola menos o raio da bola.
-const float FELT_SURFACE_Y_ACTUAL = BALL_Y_AXIS - BALL_VIRTUAL_RADIUS;
-
-// Constantes físicas
-const float GRAVITY = 9.8f; // Gravidade (em unidades/s^2, se unidades são metros, 9.8 m/s^2)
-const float RESTITUTION_COEFF = 0.8f; // Coeficiente de restituição (0.0 para sem quique, 1.0 para quique perfeito)
-const float BALL_FRICTION_FACTOR = 0.99f; // Fator de atrito para desacelerar a bola (por frame)
-const float COLLISION_EPSILON = 0.001f; // Pequeno valor para evitar problemas de "colar" na parede.
-const float VELOCITY_STOP_THRESHOLD = 0.01f; // Limiar para zerar velocidade quando muito baixa.
-
-
-
-const int PHYSICS_SUBSTEPS = 5; // Experiment with this value
-float fixedDeltaTime = 1.0f / 60.0f; // Target 60 physics updates per second, for example
-float subDeltaTime = fixedDeltaTime / PHYSICS_SUBSTEPS;
-
-const float FIXED_PHYSICS_DELTA_TIME = 1.0f / 120.0f; // Target 120 physics updates per second
+// As dimensões da mesa e as constantes físicas ficam em g_World.parameters
+// (TableParameters), que não muda depois que a física começa.
 
 
 // Variáveis para o sistema de barra de força (Power Shot)
@@ -261,12 +226,6 @@ float g_CurrentShotPowerPercentage = 0.0f; // Força atual da tacada em porcenta
 float g_MaxShotChargeTime = 5.0f; // Tempo (em segundos) para carregar 100% da força
 float g_ShotPowerPingPongDirection = 1.0f; // Direção do "ping-pong": 1.0 para carregando (0->100), -1.0 para descarregando (100->0)
 
-// Constantes para o mapeamento da porcentagem para a força real aplicada
-const float g_MinShotPowerMagnitude = 0.50f; // Força mínima do impulso (mesmo para um toque rápido)
-const float g_MaxShotPowerMagnitude = 12.0f; // Força máxima do impulso
-
-
-
 // Limite máximo para a distância da câmera no modo normal (zoom out)
 const float MAX_CAMERA_DISTANCE = 5.0f;
 
@@ -285,13 +244,6 @@ const float MAX_CAMERA_DISTANCE = 5.0f;
 //     // Você pode adicionar um ID ou nome aqui se quiser renderizá-las depois.
 // };
 
-// Segmentos de reta que formam as tabelas internas da mesa (onde a bola colide).
-// As coordenadas são o centro da bola quando em contato com a tabela.
-std::vector<BoundingSegment> g_TableSegments;
-
-std::vector<BoundingSegment> g_PocketEntrySegments;
-
-std::vector<Pocket> g_Pockets; // Variável global para armazenar todas as caçapas da mesa
 
 
 #define SPHERE 0
@@ -350,26 +302,6 @@ glm::vec2 CalculateBezierPoint(float t, const glm::vec2& p0, const glm::vec2& p1
     return point;
 }
 
-void updateSpatialGrid(const std::vector<GameBall>& balls) {
-    // Clear the grid
-    spatialGrid.assign(GRID_COLS, std::vector<std::vector<size_t>>(GRID_ROWS));
-
-    for (size_t i = 0; i < balls.size(); ++i) {
-        if (!balls[i].active) continue;
-
-        // Calculate grid cell for the ball's position
-        // You'll need to map your table coordinates to grid indices (e.g., 0 to GRID_COLS-1)
-        int col = static_cast<int>((balls[i].position.x + TABLE_HALF_WIDTH) / GRID_CELL_SIZE);
-        int row = static_cast<int>((balls[i].position.z + TABLE_HALF_DEPTH) / GRID_CELL_SIZE);
-
-        // Clamp to ensure indices are within bounds
-        col = glm::clamp(col, 0, GRID_COLS - 1);
-        row = glm::clamp(row, 0, GRID_ROWS - 1);
-
-        spatialGrid[col][row].push_back(i);
-    }
-}
-
 int main(int argc, char* argv[])
 {
     // Inicializamos a biblioteca GLFW, utilizada para criar uma janela do
@@ -514,115 +446,31 @@ int main(int argc, char* argv[])
     }
 
 
-    // 1. Inicializa o vetor global de bolas
-    g_Balls.clear(); // Limpa o vetor se ele já contiver algo
+    // Inicializa as bolas (branca + rack), as tabelas e as caçapas da mesa
+    MontarMesaPadrao(g_World);
+    g_BallRender.clear();
+    for (size_t i = 0; i < g_Balls.size(); ++i)
+    {
+        BallRenderInfo render;
+        render.object_name = "the_sphere";
+        render.object_id = 0;
+        render.shader_object_id = SPHERE; // Todas as bolas são modelos SPHERE
+        render.texture_unit_index = g_Balls.number[i]; // Bola 1 usa TextureImage[1], etc.
+        g_BallRender.push_back(render);
+    }
 
-    // 2. Bola Branca (Cue Ball)
-    GameBall cueBall;
-    cueBall.radius = BALL_VIRTUAL_RADIUS;
-    cueBall.position = glm::vec3(-0.0020f, BALL_Y_AXIS, 0.5680f); // Posição inicial da bola branca
-    cueBall.angular_velocity = glm::vec3(0.0f, 0.0f, 0.0f);
-    cueBall.orientation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
-    cueBall.velocity = glm::vec3(0.0f, 0.0f, 0.0f);
-    cueBall.active = true;
-    cueBall.object_name = "the_sphere";
-    cueBall.shader_object_id = SPHERE;
-    cueBall.texture_unit_index = 0; // Unidade de textura para a bola branca
-    g_Balls.push_back(cueBall);
+    // A partir daqui a física roda na sua própria thread, no ritmo do relógio
+    g_Physics.start();
 
     // === INICIALIZAÇÃO DA BOLA DE DEPURACAO (Temporariamente ÚNICA)
     g_DebugBall.radius = 0.1; // Usa a constante de raio que já existe
-    g_DebugBall.position = glm::vec3(-0.03f, BALL_Y_AXIS, 0.5680f); // Posição inicial para começar o debug.
+    g_DebugBall.position = glm::vec3(-0.03f, g_World.parameters.ball_y, 0.5680f); // Posição inicial para começar o debug.
     g_DebugBall.velocity = glm::vec3(0.0f, 0.0f, 0.0f); // Velocidade inicial zero (não será usada na física manual)
     g_DebugBall.active = false;
     g_DebugBall.object_name = "the_sphere";
     g_DebugBall.shader_object_id = SPHERE;
     g_DebugBall.texture_unit_index = 0;
 
-    // === INICIALIZAÇÃO DAS BOLAS NUMERADAS (OBJECT BALLS) NO RACK ===
-    int ball_id_counter = 1; // Começa de 1 (para Bola 1, Bola 2, ..., Bola 15)
-
-    for (int row = 0; row < 5; ++row) // O rack triangular tem 5 linhas
-    {
-        for (int col = 0; col <= row; ++col) // Número de bolas em cada linha (1, 2, 3, 4, 5)
-        {
-            if (ball_id_counter > 15) break; // Garante que não adicionamos mais de 15 bolas
-
-            GameBall objectBall;
-            objectBall.radius = BALL_VIRTUAL_RADIUS;
-            objectBall.velocity = glm::vec3(0.0f, 0.0f, 0.0f); // Começa parada
-            objectBall.angular_velocity = glm::vec3(0.0f, 0.0f, 0.0f);
-            objectBall.active = true;
-            objectBall.object_name = "the_sphere";
-            objectBall.shader_object_id = SPHERE; // Todas as bolas são modelos SPHERE
-
-            // Calcula a posição Z (profundidade) da bola na linha atual do rack
-            float current_z = RACK_TIP_Z_COORD - (float)row * RACK_ROW_Z_OFFSET;
-            // Calcula a posição X (horizontal) da bola na linha atual do rack
-            float current_x = (float)col * BALL_DIAMETER - (float)row * RACK_ROW_X_OFFSET;
-
-            objectBall.position = glm::vec3(current_x, BALL_Y_AXIS, current_z);
-
-            // Atribui o ID da textura: Bola 1 usa TextureImage[1], Bola 2 usa TextureImage[2], etc.
-            objectBall.orientation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
-            objectBall.texture_unit_index = ball_id_counter; // <<=== TEXTURA CORRETA
-            g_Balls.push_back(objectBall);
-
-            ball_id_counter++; // Incrementa para a próxima bola numerada
-        }
-        if (ball_id_counter > 15) break; // Se todas as 15 bolas já foram adicionadas, sai do loop externo também
-    }
-
-    // === INICIALIZAÇÃO DOS SEGMENTOS DE TABELA ===
-    // Segmento 1
-    g_TableSegments.push_back({glm::vec3(TABLE_X_MAX_BALL_CENTER, BALL_Y_AXIS, -0.0730f), glm::vec3(TABLE_X_MAX_BALL_CENTER, BALL_Y_AXIS, -1.0480f)});
-    // Segmento 2
-    g_TableSegments.push_back({glm::vec3(0.4310f, BALL_Y_AXIS, TABLE_Z_MIN_BALL_CENTER), glm::vec3(-0.4400f, BALL_Y_AXIS, TABLE_Z_MIN_BALL_CENTER)});
-    // Segmento 3
-    g_TableSegments.push_back({glm::vec3(TABLE_X_MIN_BALL_CENTER, BALL_Y_AXIS, -1.0470f), glm::vec3(TABLE_X_MIN_BALL_CENTER, BALL_Y_AXIS, -0.0730f)});
-    // Segmento 4
-    g_TableSegments.push_back({glm::vec3(TABLE_X_MIN_BALL_CENTER, BALL_Y_AXIS, 0.0760f), glm::vec3(TABLE_X_MIN_BALL_CENTER, BALL_Y_AXIS, 1.0490f)});
-    // Segmento 5
-    g_TableSegments.push_back({glm::vec3(-0.4400f, BALL_Y_AXIS, TABLE_Z_MAX_BALL_CENTER), glm::vec3(0.4340f, BALL_Y_AXIS, TABLE_Z_MAX_BALL_CENTER)});
-    // Segmento 6
-    g_TableSegments.push_back({glm::vec3(TABLE_X_MAX_BALL_CENTER , BALL_Y_AXIS, 1.0520f), glm::vec3(TABLE_X_MAX_BALL_CENTER, BALL_Y_AXIS, 0.0770f)});
-
-
-    // Caçapa Superior Esquerda
-    g_PocketEntrySegments.push_back({glm::vec3(-0.5200f, BALL_Y_AXIS, 1.0530f), glm::vec3(-0.5500f, BALL_Y_AXIS, 1.0780f)});
-    g_PocketEntrySegments.push_back({glm::vec3(-0.4400f, BALL_Y_AXIS, 1.1480f), glm::vec3(-0.4650f, BALL_Y_AXIS, 1.1730f)});
-
-    // Caçapa Superior Direita
-    g_PocketEntrySegments.push_back({glm::vec3(0.5200f, BALL_Y_AXIS, 1.0520f), glm::vec3(0.5480f, BALL_Y_AXIS, 1.0800f)});
-    g_PocketEntrySegments.push_back({glm::vec3(0.4400f, BALL_Y_AXIS, 1.1480f), glm::vec3(0.4600f, BALL_Y_AXIS, 1.1700f)});
-
-    // Caçapa Central Esquerda
-    g_PocketEntrySegments.push_back({glm::vec3(-0.5540f, BALL_Y_AXIS, 0.0600f), glm::vec3(-0.5200f, BALL_Y_AXIS, 0.0720f)});
-    g_PocketEntrySegments.push_back({glm::vec3(-0.5200f, BALL_Y_AXIS, -0.0700f), glm::vec3(-0.5460f, BALL_Y_AXIS, -0.0620f)});
-
-    // Caçapa Central Direita
-    g_PocketEntrySegments.push_back({glm::vec3(0.5180f, BALL_Y_AXIS, 0.0740f), glm::vec3(0.5440f, BALL_Y_AXIS, 0.0620f)});
-    g_PocketEntrySegments.push_back({glm::vec3(0.5200f, BALL_Y_AXIS, -0.0720f), glm::vec3(0.5480f, BALL_Y_AXIS, -0.0600f)});
-
-    // Caçapa Inferior Esquerda
-    g_PocketEntrySegments.push_back({glm::vec3(-0.5200f, BALL_Y_AXIS, -1.0500f), glm::vec3(-0.5480f, BALL_Y_AXIS, -1.0780f)});
-    g_PocketEntrySegments.push_back({glm::vec3(-0.4400f, BALL_Y_AXIS, -1.1480f), glm::vec3(-0.4640f, BALL_Y_AXIS, -1.1740f)});
-
-    // Caçapa Inferior Direita
-    g_PocketEntrySegments.push_back({glm::vec3(0.4380f, BALL_Y_AXIS, -1.1480f), glm::vec3(0.4640f, BALL_Y_AXIS, -1.1740f)});
-    g_PocketEntrySegments.push_back({glm::vec3(0.5200f, BALL_Y_AXIS, -1.0540f), glm::vec3(0.5480f, BALL_Y_AXIS, -1.0800f)});
-    // ========================================================
-
-
-    // As 6 caçapas com raio 0.1 e BALL_Y_AXIS como coordenada Y
-    g_Pockets.push_back({glm::vec3(0.5500f, BALL_Y_AXIS, 1.1900f), POCKET_SPHERE_RADIUS});
-    g_Pockets.push_back({glm::vec3(-0.5500f, BALL_Y_AXIS, 1.1900f), POCKET_SPHERE_RADIUS});
-    g_Pockets.push_back({glm::vec3(-0.6300f, BALL_Y_AXIS, 0.0000f), POCKET_SPHERE_RADIUS});
-    g_Pockets.push_back({glm::vec3(0.6300f, BALL_Y_AXIS, 0.0000f), POCKET_SPHERE_RADIUS});
-    g_Pockets.push_back({glm::vec3(-0.5740f, BALL_Y_AXIS, -1.1860f), POCKET_SPHERE_RADIUS});
-    g_Pockets.push_back({glm::vec3(0.5700f, BALL_Y_AXIS, -1.1860f), POCKET_SPHERE_RADIUS});
-    // ================================
-
     // Inicializamos o código para renderização de texto.
     TextRendering_Init();
 
@@ -666,10 +514,32 @@ int main(int argc, char* argv[])
         float deltaTime = (float)(currentFrameTime - lastFrameTime);
         lastFrameTime = currentFrameTime;
         //fprintf(stdout, "DEBUG: DeltaTime: %.4f\n", deltaTime); // Para depuração, se necessário
-        // Accumulator for fixed time steps
-        static float physics_accumulator = 0.0f;
-        physics_accumulator += deltaTime; // deltaTime from your existing calculation
-        SimularColisoes(deltaTime, g_Balls, g_TableSegments, g_PocketEntrySegments, g_Pockets, spatialGrid, g_CueBallPositioningMode);
+
+        // Estado mais recente publicado pela thread da física (não espera por
+        // ela), interpolado entre os dois últimos passos fixos
+        const BallSnapshot& balls_snapshot = g_Physics.latest();
+        const float render_alpha = balls_snapshot.interpolationAlpha(std::chrono::steady_clock::now());
+        static double last_dropped_time = 0.0;
+        if (balls_snapshot.dropped_time > last_dropped_time)
+        {
+            fprintf(stdout, "DEBUG: Fisica atrasada, %.3f s descartados (total %.3f s)\n",
+                    balls_snapshot.dropped_time - last_dropped_time, balls_snapshot.dropped_time);
+            last_dropped_time = balls_snapshot.dropped_time;
+        }
+
+        // Eventos produzidos pela física desde o último frame
+        PhysicsEvent event;
+        while (g_World.events.pop(event))
+        {
+            if (event.type == PhysicsEvent::CUE_BALL_POCKETED)
+            {
+                fprintf(stdout, "DEBUG: Bola branca encacapada!\n");
+                g_CueBallPositioningMode = true; // Entra no modo de posicionamento
+                g_CueBallPlacementValid = false;
+            }
+            else if (event.type == PhysicsEvent::BALL_POCKETED)
+                fprintf(stdout, "DEBUG: Bola %d encacapada na cacapa %d\n", event.ball, event.other);
+        }
 
 
 
@@ -951,8 +821,8 @@ int main(int argc, char* argv[])
             // O ponto para onde a câmera (look-at) estará sempre olhando: o centro da bola branca.
             // Acessamos a primeira bola do vetor g_Balls (assumindo que g_Balls[0] é a bola branca).
             // É importante verificar se g_Balls não está vazio para evitar erro de índice.
-            if (!g_Balls.empty() && g_Balls[0].active) {
-                camera_lookat_l = glm::vec4(g_Balls[0].position, 1.0f); // <<=== MUDANÇA CRUCIAL AQUI
+            if (!balls_snapshot.empty() && balls_snapshot.active[0]) {
+                camera_lookat_l = glm::vec4(balls_snapshot.renderPosition(0, render_alpha), 1.0f); // <<=== MUDANÇA CRUCIAL AQUI
             } else {
                 // Fallback: Se a bola branca não existir ou estiver inativa, olhe para a origem.
                 camera_lookat_l = glm::vec4(0.0f,0.0f,0.0f,1.0f);
@@ -1082,16 +952,21 @@ int main(int argc, char* argv[])
         // }
 
         // === DESENHAMOS TODAS AS BOLAS ===
-        for (const auto& ball : g_Balls) 
+        for (size_t i = 0; i < balls_snapshot.size(); ++i)
         {
+            const BallRenderInfo& ball = g_BallRender[i];
 
-            if (!ball.active) continue; // Só desenha se a bola estiver ativa
+            if (!balls_snapshot.active[i]) continue; // Só desenha se a bola estiver ativa
 
-            glm::mat4 ball_rotation_matrix = glm::toMat4(ball.orientation); // <<=== ADICIONE ESTA LINHA
+            // Estado interpolado entre os dois últimos passos da física, para
+            // que o movimento não engasgue quando a taxa de quadros não é
+            // múltipla da taxa da física.
+            glm::vec3 ball_position = balls_snapshot.renderPosition(i, render_alpha);
+            glm::mat4 ball_rotation_matrix = glm::toMat4(balls_snapshot.renderOrientation(i, render_alpha)); // <<=== ADICIONE ESTA LINHA
 
-            glm::mat4 model_ball = Matrix_Translate(ball.position.x, ball.position.y, ball.position.z)
+            glm::mat4 model_ball = Matrix_Translate(ball_position.x, ball_position.y, ball_position.z)
                                 * ball_rotation_matrix // <<=== ADICIONE ESTA LINHA (multiplica a rotação da bola)
-                                * Matrix_Scale(ball.radius, ball.radius, ball.radius)
+                                * Matrix_Scale(balls_snapshot.radius[i], balls_snapshot.radius[i], balls_snapshot.radius[i])
                                 * Matrix_Rotate_X(-M_PI/2.0f); // Mantenha a rotação original do modelo OBJ se necessária
                                                                 // A ordem importa: rotação do modelo OBJ primeiro, depois a rotação de rolamento.
                                                                 // OU: rotação de rolamento, depois a rotação do OBJ. Depende do seu modelo.
@@ -1115,9 +990,9 @@ int main(int argc, char* argv[])
         // === DESENHAR LINHA GUIA DE MIRA (se o modo de mira estiver ativo) ===
         if (g_AimingMode)
         {
-            if (!g_Balls.empty() && g_Balls[0].active)
+            if (!balls_snapshot.empty() && balls_snapshot.active[0])
             {
-                glm::vec3 cue_ball_pos = g_Balls[0].position; // Centro da bola branca
+                glm::vec3 cue_ball_pos = balls_snapshot.position[0]; // Centro da bola branca
 
                 // Direção da mira no plano XZ (normalizado)
                 glm::vec3 aim_direction_xz = glm::normalize(glm::vec3(glm::sin(g_AimingAngle), 0.0f, glm::cos(g_AimingAngle)));
@@ -1191,6 +1066,9 @@ int main(int argc, char* argv[])
         glfwPollEvents();
     }
 
+    // Paramos a thread da física antes de liberar o resto
+    g_Physics.stop();
+
     // Finalizamos o uso dos recursos do sistema operacional
     glfwTerminate();
 
@@ -1903,21 +1781,30 @@ void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mod)
     {
         float step = g_BallStepSize; // Um passo maior para posicionamento manual
 
+        // A posição é guardada aqui, e não lida de volta da física a cada
+        // tecla, para não perder teclas antes do próximo estado publicado
+        if (!g_CueBallPlacementValid)
+        {
+            g_CueBallPlacement = g_Physics.snapshot().position[0];
+            g_CueBallPlacementValid = true;
+        }
+
         if (key == GLFW_KEY_LEFT) {
-            g_Balls[0].position.x -= step;
+            g_CueBallPlacement.x -= step;
         }
         if (key == GLFW_KEY_RIGHT) {
-            g_Balls[0].position.x += step;
+            g_CueBallPlacement.x += step;
         }
         // Para mover para frente/trás na mesa (eixo Z)
         if (key == GLFW_KEY_UP) {
-            g_Balls[0].position.z -= step; // Z negativo é "para frente" na mesa
+            g_CueBallPlacement.z -= step; // Z negativo é "para frente" na mesa
         }
         if (key == GLFW_KEY_DOWN) {
-            g_Balls[0].position.z += step; // Z positivo é "para trás" na mesa
+            g_CueBallPlacement.z += step; // Z positivo é "para trás" na mesa
         }
         // A altura Y da bola deve permanecer fixa
-        g_Balls[0].position.y = BALL_Y_AXIS;
+        g_CueBallPlacement.y = g_World.parameters.ball_y;
+        g_Physics.setPosition(0, g_CueBallPlacement); // Acorda a bola, que pode ter sido colocada encostada em outra
 
         // Sair do modo de posicionamento e permitir o chute
         if (key == GLFW_KEY_ENTER || key == GLFW_KEY_SPACE) // Tecla Enter ou Espaço para confirmar
@@ -1925,7 +1812,7 @@ void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mod)
             g_CueBallPositioningMode = false;
             fprintf(stdout, "DEBUG: Bola branca posicionada. Modo de jogo reativado.\n");
         }
-        fprintf(stdout, "DEBUG: Posicao da Bola Branca: (%.4f, %.4f, %.4f)\n", g_Balls[0].position.x, g_Balls[0].position.y, g_Balls[0].position.z);
+        fprintf(stdout, "DEBUG: Posicao da Bola Branca: (%.4f, %.4f, %.4f)\n", g_CueBallPlacement.x, g_CueBallPlacement.y, g_CueBallPlacement.z);
     }
 
 
@@ -1936,7 +1823,7 @@ void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mod)
         // Reinicia a bola para uma posição conhecida (útil se ela sair do controle)
         if (key == GLFW_KEY_R) // Exemplo: Tecla 'R' para Resetar a bola
         {
-            g_DebugBall.position = glm::vec3(-0.0020f, BALL_Y_AXIS, 0.5680f); // Posição inicial
+            g_DebugBall.position = glm::vec3(-0.0020f, g_World.parameters.ball_y, 0.5680f); // Posição inicial
             fprintf(stdout, "DEBUG: Bola resetada para a posicao inicial. Pos: (%.4f, %.4f, %.4f)\n", g_DebugBall.position.x, g_DebugBall.position.y, g_DebugBall.position.z);
         }
 
@@ -1990,7 +1877,7 @@ void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mod)
     if (key == GLFW_KEY_T && action == GLFW_PRESS)
     {
         // Só permite ativar o modo de mira se a bola branca estiver parada e ativa
-        if (!g_AimingMode && !g_Balls.empty() )
+        if (!g_AimingMode && !g_Physics.snapshot().empty() )
         {
             g_AimingMode = true;
             g_AimingAngle = g_CameraTheta + M_PI; // Inicializa o ângulo de mira com base na direção da câmera
@@ -2010,7 +1897,7 @@ void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mod)
     {
         // Só permite iniciar o carregamento da força se o modo de mira estiver ativo
         // e a bola branca estiver ativa.
-        if (g_AimingMode && !g_Balls.empty() && g_Balls[0].active )
+        if (g_AimingMode && !g_Physics.snapshot().empty() && g_Physics.snapshot().active[0] )
         {
             g_P_KeyHeld = true; // Sinaliza que 'P' está pressionada
             g_P_PressStartTime = glfwGetTime(); // Registra o tempo de início
@@ -2028,20 +1915,15 @@ void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mod)
             g_P_KeyHeld = false; // Sinaliza que 'P' não está mais sendo pressionada
             fprintf(stdout, "DEBUG: Modo de Mira DESATIVADO (Tacada!).\n");
 
-            // Calcula a força final com base na porcentagem atual
-            float shot_power_magnitude = g_MinShotPowerMagnitude + (g_MaxShotPowerMagnitude - g_MinShotPowerMagnitude) * (g_CurrentShotPowerPercentage / 100.0f);
-
-            // Calcula o vetor de direção da tacada a partir do g_AimingAngle
-            glm::vec3 shoot_direction = glm::vec3(glm::sin(g_AimingAngle), 0.0f, glm::cos(g_AimingAngle));
-            shoot_direction = glm::normalize(shoot_direction); // Normaliza para ter comprimento 1
-
-            // Aplica a velocidade à bola branca
-            if (!g_Balls.empty() && g_Balls[0].active) {
-                g_Balls[0].velocity = shoot_direction * shot_power_magnitude;
+            // Aplica a velocidade à bola branca, calculada a partir do
+            // g_AimingAngle e da porcentagem atual de força
+            if (!g_Physics.snapshot().empty() && g_Physics.snapshot().active[0]) {
+                glm::vec3 shot_velocity = VelocidadeDaTacada(g_AimingAngle, g_CurrentShotPowerPercentage);
+                g_Physics.setVelocity(0, shot_velocity);
                 g_AimingMode = false;
                 fprintf(stdout, "DEBUG: Tacada! Forca %.2f%%. Vel: (%.2f, %.2f, %.2f)\n",
                         g_CurrentShotPowerPercentage,
-                        g_Balls[0].velocity.x, g_Balls[0].velocity.y, g_Balls[0].velocity.z);
+                        shot_velocity.x, shot_velocity.y, shot_velocity.z);
             }
             fflush(stdout);
         }
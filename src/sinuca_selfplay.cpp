@@ -0,0 +1,507 @@
+// Arquivo: sinuca_selfplay.cpp
+//
+// Partidas da IA contra ela mesma, sem janela. Cada partida começa com as 15
+// bolas no triângulo (MontarMesaPadrao) e vai até a última bola numerada
+// cair, com duas políticas de tacada se alternando. As partidas são
+// divididas entre todos os núcleos da CPU e o programa escreve as
+// estatísticas de cada partida e do conjunto em CSV. Serve de benchmark de
+// desempenho da física (passos por segundo com partidas reais) e de bancada
+// para ajustar a IA (uma política contra a outra).
+//
+// Uso:
+//   sinuca_selfplay [--games N] [--threads N] [--policy-a nome] [--policy-b nome]
+//                   [--candidates K] [--max-shots N] [--max-time segundos]
+//                   [--noise angulo forca] [--seed S] [--table arquivo]
+//                   [--csv arquivo] [--summary arquivo] [--cache MB]
+//
+// Políticas:
+//   random      ângulo e força aleatórios
+//   greedy      a melhor candidata pela estimativa analítica, sem simular
+//   candidates  simula as K melhores candidatas (AvaliarCandidatas)
+//   grid        simula uma grade de ângulos e forças (AvaliarTacadas)
+//
+// Regras (simplificadas, sem grupos de bolas): quem encaçapa alguma bola sem
+// derrubar a branca joga de novo; senão a vez passa. A branca encaçapada
+// volta para o seu ponto (a física já faz isso), sem bola na mão. Ganha quem
+// encaçapou mais bolas; a partida termina quando não sobra bola numerada ou
+// depois de --max-shots tacadas. Os jogadores se alternam na abertura, que é
+// sempre uma tacada em força máxima da branca na direção do triângulo.
+//
+// Cada tacada executada recebe um ruído normal de ângulo (radianos) e força
+// (pontos percentuais), dado por --noise, imitando a imprecisão de um
+// jogador; sem isso todas as partidas seriam iguais. Cada partida tem a sua
+// semente (--seed mais o número da partida), então o resultado de cada
+// partida não depende do número de threads.
+//
+// --csv escreve uma linha por partida. A linha agregada (partidas por
+// segundo, tacadas, brancas encaçapadas e passos de simulação por partida,
+// passos por segundo) sai na saída padrão e, com --summary, é acrescentada
+// ao arquivo, que recebe o cabeçalho só quando está vazio, para acompanhar o
+// desempenho entre versões.
+//
+// Com --cache MB, as partidas dividem uma TranspositionCache de até MB
+// megabytes: a tacada escolhida por uma política de simulação em uma mesa e
+// o resultado de cada tacada simulada ficam guardados, e mesas com o mesmo
+// TableState não são avaliadas de novo. A cache não muda as partidas, só o
+// tempo para escolher as tacadas (a mesa de abertura, por exemplo, se repete
+// em todas). Os acertos da cache saem na saída de erro.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "PhysicsWorld.h"
+#include "Mesa.h"
+#include "ThreadPool.h"
+#include "ShotEvaluator.h"
+#include "ShotCandidates.h"
+#include "TableState.h"
+#include "TranspositionCache.h"
+
+// Grade da política grid: ângulos (volta inteira) x forças
+const int   GRID_ANGLES = 36;
+const int   GRID_POWERS = 3;
+const float GRID_POWER_MIN = 30.0f;
+const float GRID_POWER_MAX = 100.0f;
+
+// Faixa de forças da política random
+const float RANDOM_POWER_MIN = 20.0f;
+const float RANDOM_POWER_MAX = 100.0f;
+
+enum Policy {
+    POLICY_RANDOM,
+    POLICY_GREEDY,
+    POLICY_CANDIDATES,
+    POLICY_GRID
+};
+
+static const char* NomeDaPolitica(Policy policy)
+{
+    switch (policy)
+    {
+    case POLICY_RANDOM:     return "random";
+    case POLICY_GREEDY:     return "greedy";
+    case POLICY_CANDIDATES: return "candidates";
+    case POLICY_GRID:       return "grid";
+    }
+    return "?";
+}
+
+static bool PoliticaPorNome(const char* name, Policy& policy)
+{
+    const Policy all[] = {POLICY_RANDOM, POLICY_GREEDY, POLICY_CANDIDATES, POLICY_GRID};
+    for (Policy p : all)
+    {
+        if (std::strcmp(name, NomeDaPolitica(p)) == 0)
+        {
+            policy = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+struct SelfPlaySettings {
+    Policy   policies[2];
+    int      max_candidates;    // K da política candidates
+    int      max_shots;         // Tacadas por partida, somando os dois jogadores
+    float    max_time_per_shot; // Tempo simulado máximo por tacada, em segundos
+    float    angle_noise;       // Ruído da tacada executada, em radianos
+    float    power_noise;       // Ruído da tacada executada, em pontos percentuais
+    uint32_t seed;
+    TranspositionCache* cache;  // NULL: sem cache
+};
+
+struct GameResult {
+    int       breaker;          // Jogador que abriu (0 = A, 1 = B)
+    int       winner;           // 0 = A, 1 = B, -1 = empate
+    bool      finished;         // Todas as bolas numeradas caíram
+    int       shots[2];
+    int       potted[2];
+    int       scratches[2];
+    long long steps;            // Passos fixos simulados nas tacadas executadas
+    long long substeps;
+    double    sim_time;         // Tempo simulado, em segundos
+    long long ai_simulations;   // Simulações feitas pelas políticas para escolher as tacadas
+    double    seconds;          // Tempo real da partida
+};
+
+static int BolasNumeradasEmJogo(const BallState& balls)
+{
+    int count = 0;
+    for (size_t i = 0; i < balls.size(); ++i)
+        if (balls.active[i] && balls.number[i] != 0)
+            ++count;
+    return count;
+}
+
+// Tacada aleatória, também usada quando uma política não acha nenhuma
+static ShotParameters TacadaAleatoria(std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> angle(0.0f, 2.0f * glm::pi<float>());
+    std::uniform_real_distribution<float> power(RANDOM_POWER_MIN, RANDOM_POWER_MAX);
+    ShotParameters shot;
+    shot.angle = angle(rng);
+    shot.power = power(rng);
+    return shot;
+}
+
+// Escolhe a tacada da política a partir da mesa como ela está. As políticas
+// que simulam usam a thread que chama (as threads já estão divididas entre as
+// partidas) e somam as simulações feitas em ai_simulations.
+static ShotParameters EscolherTacada(Policy policy, const PhysicsWorld& world, const SelfPlaySettings& settings,
+                                     std::mt19937& rng, long long& ai_simulations)
+{
+    ShotEvaluation evaluation;
+    evaluation.max_time = settings.max_time_per_shot;
+    evaluation.cache = settings.cache;
+
+    // A semente das simulações vem da mesa, com ou sem cache: a mesma mesa
+    // leva sempre à mesma tacada, e a cache não muda as partidas
+    TableState state;
+    const bool has_state = world.saveState(state);
+    evaluation.seed = has_state ? static_cast<uint32_t>(MisturarChaves(state.hash(), settings.seed)) : rng();
+
+    // Tacada já escolhida por esta política na mesma mesa
+    uint64_t key = 0;
+    const bool cached = settings.cache != NULL && (policy == POLICY_CANDIDATES || policy == POLICY_GRID) && has_state;
+    if (cached)
+    {
+        key = MisturarChaves(state.hash(),
+                             (static_cast<uint64_t>(policy) << 32) | static_cast<uint32_t>(settings.max_candidates));
+        ShotOutcome outcome;
+        if (settings.cache->find(key, outcome))
+            return outcome.shot;
+    }
+
+    switch (policy)
+    {
+    case POLICY_RANDOM:
+        break;
+    case POLICY_GREEDY:
+    {
+        std::vector<ShotCandidate> candidates = GerarCandidatas(world, CandidateSettings());
+        if (!candidates.empty())
+            return candidates[0].shot;
+        break;
+    }
+    case POLICY_CANDIDATES:
+    {
+        std::vector<ShotOutcome> outcomes = AvaliarCandidatas(world, settings.max_candidates, CandidateSettings(), evaluation, NULL,
+                                                             &ai_simulations);
+        if (!outcomes.empty())
+        {
+            if (cached)
+                settings.cache->insert(key, outcomes[0]);
+            return outcomes[0].shot;
+        }
+        break;
+    }
+    case POLICY_GRID:
+    {
+        std::vector<ShotParameters> shots = GradeDeTacadas(0.0f, 2.0f * glm::pi<float>(), GRID_ANGLES,
+                                                           GRID_POWER_MIN, GRID_POWER_MAX, GRID_POWERS);
+        std::vector<ShotOutcome> outcomes = AvaliarTacadas(world, shots, evaluation, NULL, &ai_simulations);
+        if (!outcomes.empty())
+        {
+            if (cached)
+                settings.cache->insert(key, outcomes[0]);
+            return outcomes[0].shot;
+        }
+        break;
+    }
+    }
+    return TacadaAleatoria(rng);
+}
+
+// Joga uma partida inteira a partir de table
+static GameResult JogarPartida(const PhysicsWorld& table, const SelfPlaySettings& settings, int game)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    PhysicsWorld world = table;
+    world.threadPool = NULL;
+    world.integrateOrientation = false; // Sem desenho, o rolamento não importa
+    PhysicsEvent event;
+    while (world.events.pop(event)) {}
+
+    GameResult result;
+    std::memset(&result, 0, sizeof(result));
+    result.breaker = game % 2;
+
+    std::mt19937 rng(settings.seed + static_cast<uint32_t>(game) * 2654435761u);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+
+    int player = result.breaker;
+    int remaining = BolasNumeradasEmJogo(world.balls);
+    int total_shots = 0;
+    while (remaining > 0 && total_shots < settings.max_shots && world.balls.active[0])
+    {
+        ShotParameters shot;
+        if (total_shots == 0)
+        {
+            // Abertura: força máxima na direção do triângulo
+            glm::vec2 to_rack = world.parameters.rack_apex - glm::vec2(world.balls.px[0], world.balls.pz[0]);
+            shot.angle = std::atan2(to_rack.x, to_rack.y);
+            shot.power = 100.0f;
+        }
+        else
+        {
+            shot = EscolherTacada(settings.policies[player], world, settings, rng, result.ai_simulations);
+        }
+        shot.angle += settings.angle_noise * noise(rng);
+        shot.power = glm::clamp(shot.power + settings.power_noise * noise(rng), 0.0f, 100.0f);
+
+        world.balls.setVelocity(0, VelocidadeDaTacada(shot.angle, shot.power));
+        int potted = 0;
+        bool scratch = false;
+        const double shot_start = world.simTime;
+        do
+        {
+            result.substeps += world.SimularColisoes();
+            ++result.steps;
+            while (world.events.pop(event))
+            {
+                if (event.type == PhysicsEvent::BALL_POCKETED)
+                    ++potted;
+                else if (event.type == PhysicsEvent::CUE_BALL_POCKETED)
+                    scratch = true;
+            }
+        } while (!BolasParadas(world.balls) && world.simTime - shot_start < settings.max_time_per_shot);
+
+        // Bolas que ainda rolam depois de max_time param onde estão, para a
+        // próxima tacada começar com a mesa parada
+        if (!BolasParadas(world.balls))
+        {
+            for (size_t i = 0; i < world.balls.size(); ++i)
+            {
+                world.balls.setVelocity(i, glm::vec3(0.0f));
+                world.balls.setSpinVelocity(i, glm::vec2(0.0f));
+            }
+        }
+
+        ++total_shots;
+        ++result.shots[player];
+        result.potted[player] += potted;
+        remaining -= potted;
+        if (scratch)
+            ++result.scratches[player];
+        if (potted == 0 || scratch)
+            player = 1 - player;
+    }
+
+    result.finished = remaining <= 0;
+    result.winner = result.potted[0] > result.potted[1] ? 0 : (result.potted[1] > result.potted[0] ? 1 : -1);
+    result.sim_time = world.simTime - table.simTime;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+static bool EscreverPartidas(const char* filename, const std::vector<GameResult>& results)
+{
+    FILE* file = std::fopen(filename, "w");
+    if (!file)
+    {
+        fprintf(stderr, "ERROR: Cannot open CSV file \"%s\".\n", filename);
+        return false;
+    }
+    fprintf(file, "game,breaker,winner,finished,shots,shots_a,shots_b,potted_a,potted_b,scratches_a,scratches_b,"
+                  "steps,substeps,sim_time,ai_simulations,wall_ms\n");
+    for (size_t g = 0; g < results.size(); ++g)
+    {
+        const GameResult& r = results[g];
+        fprintf(file, "%zu,%c,%s,%d,%d,%d,%d,%d,%d,%d,%d,%lld,%lld,%.3f,%lld,%.3f\n",
+                g, r.breaker == 0 ? 'A' : 'B', r.winner < 0 ? "draw" : (r.winner == 0 ? "A" : "B"),
+                r.finished ? 1 : 0, r.shots[0] + r.shots[1], r.shots[0], r.shots[1], r.potted[0], r.potted[1],
+                r.scratches[0], r.scratches[1], r.steps, r.substeps, r.sim_time, r.ai_simulations,
+                r.seconds * 1000.0);
+    }
+    std::fclose(file);
+    return true;
+}
+
+// Escreve a linha agregada em file, com o cabeçalho se header
+static void EscreverResumo(FILE* file, bool header, const SelfPlaySettings& settings, const std::vector<GameResult>& results,
+                           unsigned num_threads, double seconds)
+{
+    long long wins[2] = {0, 0}, draws = 0, finished = 0, shots = 0, scratches = 0, potted = 0;
+    long long steps = 0, substeps = 0, ai_simulations = 0;
+    for (const GameResult& r : results)
+    {
+        if (r.winner < 0)
+            ++draws;
+        else
+            ++wins[r.winner];
+        finished += r.finished ? 1 : 0;
+        shots += r.shots[0] + r.shots[1];
+        scratches += r.scratches[0] + r.scratches[1];
+        potted += r.potted[0] + r.potted[1];
+        steps += r.steps;
+        substeps += r.substeps;
+        ai_simulations += r.ai_simulations;
+    }
+    const double games = results.empty() ? 1.0 : static_cast<double>(results.size());
+    const double rate = seconds > 0.0 ? 1.0 / seconds : 0.0;
+
+    if (header)
+        fprintf(file, "games,threads,policy_a,policy_b,wins_a,wins_b,draws,finished,seconds,games_per_sec,"
+                      "shots_per_game,scratches_per_game,potted_per_game,steps_per_game,steps_per_sec,"
+                      "substeps_per_sec,ai_simulations_per_shot\n");
+    fprintf(file, "%zu,%u,%s,%s,%lld,%lld,%lld,%lld,%.3f,%.3f,%.2f,%.3f,%.2f,%.1f,%.0f,%.0f,%.2f\n",
+            results.size(), num_threads, NomeDaPolitica(settings.policies[0]), NomeDaPolitica(settings.policies[1]),
+            wins[0], wins[1], draws, finished, seconds, results.size() * rate, shots / games, scratches / games,
+            potted / games, steps / games, steps * rate, substeps * rate,
+            shots > 0 ? static_cast<double>(ai_simulations) / shots : 0.0);
+}
+
+static void ImprimirUso(const char* program)
+{
+    fprintf(stderr,
+            "Uso: %s [--games N] [--threads N] [--policy-a random|greedy|candidates|grid] [--policy-b random|greedy|candidates|grid] [--candidates K] [--max-shots N] [--max-time segundos] [--noise angulo forca] [--seed S] [--table arquivo] [--csv arquivo] [--summary arquivo] [--cache MB]\n",
+            program);
+}
+
+int main(int argc, char* argv[])
+{
+    const char* table_file = NULL;
+    const char* csv_file = NULL;
+    const char* summary_file = NULL;
+    int num_games = 100;
+    int num_threads = 0; // 0: todos os núcleos
+    int cache_megabytes = 0;
+
+    SelfPlaySettings settings;
+    settings.policies[0] = POLICY_CANDIDATES;
+    settings.policies[1] = POLICY_GREEDY;
+    settings.max_candidates = 8;
+    settings.max_shots = 200;
+    settings.max_time_per_shot = 20.0f;
+    settings.angle_noise = 0.004f;
+    settings.power_noise = 2.0f;
+    settings.seed = 1;
+    settings.cache = NULL;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--games") == 0 && i + 1 < argc)
+        {
+            num_games = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            num_threads = std::max(1, std::atoi(argv[++i]));
+        }
+        else if ((std::strcmp(argv[i], "--policy-a") == 0 || std::strcmp(argv[i], "--policy-b") == 0) && i + 1 < argc)
+        {
+            Policy& policy = settings.policies[argv[i][9] == 'a' ? 0 : 1];
+            const char* name = argv[++i];
+            if (!PoliticaPorNome(name, policy))
+            {
+                fprintf(stderr, "ERROR: Policy \"%s\" is unknown (use random, greedy, candidates or grid).\n", name);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (std::strcmp(argv[i], "--candidates") == 0 && i + 1 < argc)
+        {
+            settings.max_candidates = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--max-shots") == 0 && i + 1 < argc)
+        {
+            settings.max_shots = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--max-time") == 0 && i + 1 < argc)
+        {
+            settings.max_time_per_shot = (float)std::atof(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--noise") == 0 && i + 2 < argc)
+        {
+            settings.angle_noise = std::max(0.0f, (float)std::atof(argv[++i]));
+            settings.power_noise = std::max(0.0f, (float)std::atof(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            settings.seed = static_cast<uint32_t>(std::strtoul(argv[++i], NULL, 10));
+        }
+        else if (std::strcmp(argv[i], "--table") == 0 && i + 1 < argc)
+        {
+            table_file = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--csv") == 0 && i + 1 < argc)
+        {
+            csv_file = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--summary") == 0 && i + 1 < argc)
+        {
+            summary_file = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--cache") == 0 && i + 1 < argc)
+        {
+            cache_megabytes = std::max(1, std::atoi(argv[++i]));
+        }
+        else
+        {
+            ImprimirUso(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    PhysicsWorld table;
+    MontarMesaPadrao(table);
+    if (table_file && !CarregarMesa(table_file, table))
+        return EXIT_FAILURE;
+
+    if (num_threads == 0)
+        num_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    num_threads = std::min(num_threads, num_games);
+    ThreadPool pool(static_cast<unsigned>(num_threads));
+
+    std::unique_ptr<TranspositionCache> cache;
+    if (cache_megabytes > 0)
+    {
+        cache.reset(new TranspositionCache(static_cast<size_t>(cache_megabytes) << 20));
+        settings.cache = cache.get();
+    }
+
+    // Uma tarefa por partida; o pool entrega a próxima partida para a thread
+    // que terminar primeiro
+    std::vector<GameResult> results(num_games);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    pool.parallelFor(results.size(), [&](size_t game, unsigned) {
+        results[game] = JogarPartida(table, settings, static_cast<int>(game));
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (cache)
+    {
+        TranspositionStats stats = cache->stats();
+        fprintf(stderr, "Cache: %lld acertos, %lld faltas (%.1f%%), %lld inserções, %lld substituições, %zu entradas, %.1f MB\n",
+                stats.hits, stats.misses, stats.hits + stats.misses > 0 ? 100.0 * stats.hits / (stats.hits + stats.misses) : 0.0,
+                stats.insertions, stats.evictions, cache->capacity(), cache->memoryUsage() / (1024.0 * 1024.0));
+    }
+
+    if (csv_file && !EscreverPartidas(csv_file, results))
+        return EXIT_FAILURE;
+
+    EscreverResumo(stdout, true, settings, results, pool.size(), seconds);
+    if (summary_file)
+    {
+        FILE* file = std::fopen(summary_file, "a");
+        if (!file)
+        {
+            fprintf(stderr, "ERROR: Cannot open summary file \"%s\".\n", summary_file);
+            return EXIT_FAILURE;
+        }
+        std::fseek(file, 0, SEEK_END);
+        EscreverResumo(file, std::ftell(file) == 0, settings, results, pool.size(), seconds);
+        std::fclose(file);
+    }
+    return EXIT_SUCCESS;
+}
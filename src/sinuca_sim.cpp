@@ -0,0 +1,808 @@
+// Arquivo: sinuca_sim.cpp
+//
+// Simulador de linha de comando, sem janela. Carrega um layout de mesa,
+// aplica uma lista de tacadas na bola branca e roda a física na velocidade
+// máxima da CPU, sem depender do V-Sync do loop de renderização.
+//
+// Uso:
+//   sinuca_sim [--table arquivo] [--layout arquivo] [--shots arquivo] [--shot angulo forca]...
+//              [--max-time segundos] [--tables N] [--bench N]... [--events]
+//              [--realtime] [--broadphase grid|sap] [--stress N]... [--threads N]
+//              [--evaluate angulos forcas amostras] [--candidates K] [--check-state]
+//
+// O ângulo é dado em graus (mesma convenção de g_AimingAngle) e a força em
+// porcentagem (0 a 100). O arquivo de tacadas tem uma tacada por linha no
+// formato "<angulo> <forca>"; linhas começando com '#' são ignoradas.
+//
+// --table carrega outra mesa (dimensões, tabelas, caçapas e coeficientes;
+// veja data/mesas) no lugar da mesa padrão do jogo.
+//
+// Com --tables N, N mesas independentes (cada uma com o seu PhysicsWorld)
+// rodam as mesmas tacadas em paralelo, uma thread por núcleo da CPU.
+//
+// Com --events, as tacadas usam a simulação orientada a eventos
+// (EventSimulation) em vez dos passos fixos de 1/120 s.
+//
+// Com --realtime, a física roda em tempo real na PhysicsThread, como no
+// jogo, e o programa lê o estado publicado a 60 quadros por segundo.
+//
+// Como nada é desenhado, a orientação (rolamento) das bolas não é calculada.
+//
+// Com --bench N, em vez das tacadas, mede o tempo médio de um passo fixo com
+// N bolas espalhadas em grade pela mesa, com velocidades aleatórias (semente
+// fixa). Quando N bolas não cabem na mesa com o raio padrão, o raio é
+// reduzido para que elas não comecem sobrepostas. Sem --broadphase, cada
+// tamanho é medido com as duas broadphases (grid e sweep-and-prune).
+//
+// Com --stress N, N bolas do tamanho normal rodam numa mesa retangular
+// aumentada até caberem todas (de milhares a centenas de milhares de bolas),
+// e o programa mostra passos por segundo, testes de pares por segundo e a
+// memória por bola.
+//
+// Com --threads N, o passo fixo divide o trabalho entre N threads
+// (PhysicsWorld::threadPool) quando há muitas bolas acordadas; o resultado é
+// o mesmo com qualquer N. Não pode ser usado junto com --tables.
+//
+// Com --evaluate A F S, em vez das tacadas, avalia A ângulos (volta inteira)
+// x F forças (de 25% a 100%) a partir da mesa inicial, S simulações com
+// ruído por tacada (AvaliarTacadas), e mostra as melhores tacadas e quantas
+// simulações por segundo foram feitas. Sem --threads usa todos os núcleos.
+//
+// Com --candidates K, em vez da grade, gera as tacadas candidatas pela
+// geometria da bola fantasma (diretas, de tabela e combinações), mostra as
+// melhores pela estimativa analítica e simula só as K melhores.
+//
+// Com --check-state, em vez das tacadas, confere o TableState no meio da
+// tacada de abertura: salvar, restaurar e salvar de novo dá os mesmos bytes
+// e não muda a memória do mundo. Sai com erro se não der.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "PhysicsWorld.h"
+#include "Mesa.h"
+#include "EventSimulation.h"
+#include "PhysicsThread.h"
+#include "ThreadPool.h"
+#include "ShotEvaluator.h"
+#include "ShotCandidates.h"
+#include "TableState.h"
+
+struct Tacada {
+    float angle_degrees;
+    float power_percentage;
+};
+
+static bool CarregarTacadas(const char* filename, std::vector<Tacada>& shots)
+{
+    std::ifstream file(filename);
+    if (!file)
+    {
+        fprintf(stderr, "ERROR: Cannot open shots file \"%s\".\n", filename);
+        return false;
+    }
+
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line))
+    {
+        ++line_number;
+        std::istringstream in(line);
+        std::string first;
+        if (!(in >> first) || first[0] == '#')
+            continue;
+
+        Tacada shot;
+        std::istringstream number(first);
+        if (!(number >> shot.angle_degrees) || !(in >> shot.power_percentage))
+        {
+            fprintf(stderr, "ERROR: Invalid line %d in shots file \"%s\".\n", line_number, filename);
+            return false;
+        }
+        shots.push_back(shot);
+    }
+    return true;
+}
+
+// Contagem dos eventos da física em uma tacada
+struct ContagemEventos {
+    long long pocketed;   // Bolas numeradas encaçapadas
+    long long ball_ball;  // Choques entre bolas
+    long long cushion;    // Choques com tabelas e entradas de caçapa
+    bool cue_ball_pocketed;
+};
+
+// Esvazia a fila de eventos do mundo, somando os eventos em count
+static void DrenarEventos(PhysicsWorld& world, ContagemEventos& count)
+{
+    PhysicsEvent event;
+    while (world.events.pop(event))
+    {
+        switch (event.type)
+        {
+        case PhysicsEvent::BALL_POCKETED:     count.pocketed++; break;
+        case PhysicsEvent::CUE_BALL_POCKETED: count.cue_ball_pocketed = true; break;
+        case PhysicsEvent::BALL_BALL:         count.ball_ball++; break;
+        case PhysicsEvent::BALL_CUSHION:      count.cushion++; break;
+        }
+    }
+}
+
+// Aplica as tacadas em sequência na mesa, esperando as bolas pararem (ou o
+// limite de passos) entre uma tacada e outra. Retorna o total de passos.
+static long long SimularTacadas(PhysicsWorld& world, const std::vector<Tacada>& shots, int max_steps_per_shot, bool verbose);
+
+// Igual a SimularTacadas, mas com a simulação orientada a eventos. Retorna o
+// total de eventos processados.
+static long long SimularTacadasPorEventos(PhysicsWorld& world, const std::vector<Tacada>& shots, float max_time_per_shot, bool verbose)
+{
+    long long total_events = 0;
+    EventSimulation simulation(world);
+    for (size_t s = 0; s < shots.size(); ++s)
+    {
+        if (world.balls.empty() || !world.balls.active[0])
+            break;
+
+        float angle = glm::radians(shots[s].angle_degrees);
+        world.balls.setVelocity(0, VelocidadeDaTacada(angle, shots[s].power_percentage));
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        EventStats stats = simulation.run(max_time_per_shot);
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        total_events += stats.events;
+
+        ContagemEventos count = {0, 0, 0, false};
+        DrenarEventos(world, count);
+
+        if (verbose)
+        {
+            double seconds = std::chrono::duration<double>(end - start).count();
+            printf("Tacada %zu: angulo %.2f forca %.1f%% -> %lld eventos (%lld bola-bola, %lld tabela, %lld cacapa, %lld descartados), %.3f s simulados em %.3f ms%s\n",
+                   s + 1, shots[s].angle_degrees, shots[s].power_percentage,
+                   stats.events, stats.ball_ball, stats.cushion, stats.pocket, stats.discarded,
+                   stats.sim_time, seconds * 1000.0,
+                   count.cue_ball_pocketed ? " (bola branca encacapada)" : "");
+        }
+    }
+    return total_events;
+}
+
+static long long SimularTacadas(PhysicsWorld& world, const std::vector<Tacada>& shots, int max_steps_per_shot, bool verbose)
+{
+    long long total_steps = 0;
+    for (size_t s = 0; s < shots.size(); ++s)
+    {
+        if (world.balls.empty() || !world.balls.active[0])
+            break;
+
+        float angle = glm::radians(shots[s].angle_degrees);
+        world.balls.setVelocity(0, VelocidadeDaTacada(angle, shots[s].power_percentage));
+
+        int steps = 0;
+        long long substeps = 0;
+        ContagemEventos count = {0, 0, 0, false};
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        do
+        {
+            steps += world.step(FIXED_PHYSICS_DELTA_TIME);
+            substeps += world.substepsLastFrame();
+            DrenarEventos(world, count);
+        } while (!BolasParadas(world.balls) && steps < max_steps_per_shot);
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        total_steps += steps;
+
+        if (verbose)
+        {
+            double seconds = std::chrono::duration<double>(end - start).count();
+            printf("Tacada %zu: angulo %.2f forca %.1f%% -> %d passos, %lld subpassos (%.3f s simulados) em %.3f ms, %.0f passos/s; "
+                   "%lld bola-bola, %lld tabela, %lld encacapadas%s\n",
+                   s + 1, shots[s].angle_degrees, shots[s].power_percentage,
+                   steps, substeps, steps * FIXED_PHYSICS_DELTA_TIME, seconds * 1000.0,
+                   seconds > 0.0 ? steps / seconds : 0.0,
+                   count.ball_ball, count.cushion, count.pocketed,
+                   count.cue_ball_pocketed ? " (bola branca encacapada)" : "");
+        }
+    }
+    return total_steps;
+}
+
+// Igual a SimularTacadas, mas em tempo real: a física roda na PhysicsThread
+// e esta thread faz o papel do desenho, lendo o estado mais recente a cada
+// 1/60 s e mandando as tacadas pela fila de comandos. Retorna o total de
+// quadros "desenhados".
+static long long SimularTacadasEmTempoReal(PhysicsWorld& world, const std::vector<Tacada>& shots, float max_time_per_shot, bool verbose)
+{
+    const std::chrono::duration<double> frame_time(1.0 / 60.0);
+    long long total_frames = 0;
+    PhysicsThread physics(world);
+    physics.start();
+    for (size_t s = 0; s < shots.size(); ++s)
+    {
+        if (physics.latest().empty() || !physics.snapshot().active[0])
+            break;
+
+        float angle = glm::radians(shots[s].angle_degrees);
+        physics.setVelocity(0, VelocidadeDaTacada(angle, shots[s].power_percentage));
+
+        // Espera a tacada aparecer (bolas em movimento) e depois as bolas pararem
+        long long frames = 0, new_snapshots = 0;
+        bool moving = false;
+        double start_sim_time = physics.snapshot().sim_time;
+        ContagemEventos count = {0, 0, 0, false};
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point next_frame = start;
+        while (std::chrono::steady_clock::now() - start < std::chrono::duration<float>(max_time_per_shot))
+        {
+            next_frame += std::chrono::duration_cast<std::chrono::steady_clock::duration>(frame_time);
+            std::this_thread::sleep_until(next_frame);
+            ++frames;
+
+            const double previous_sim_time = physics.snapshot().sim_time;
+            const BallSnapshot& snapshot = physics.latest();
+            if (snapshot.sim_time != previous_sim_time)
+                ++new_snapshots;
+            DrenarEventos(world, count); // Consumidor da fila de eventos é esta thread
+            if (!snapshot.stopped)
+                moving = true;
+            else if (moving)
+                break;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        total_frames += frames;
+
+        if (verbose)
+        {
+            printf("Tacada %zu: angulo %.2f forca %.1f%% -> %lld quadros, %lld estados novos, %.3f s reais (%.3f s simulados); "
+                   "%lld bola-bola, %lld tabela, %lld encacapadas%s\n",
+                   s + 1, shots[s].angle_degrees, shots[s].power_percentage,
+                   frames, new_snapshots, seconds, physics.snapshot().sim_time - start_sim_time,
+                   count.ball_ball, count.cushion, count.pocketed,
+                   count.cue_ball_pocketed ? " (bola branca encacapada)" : "");
+        }
+    }
+    physics.stop();
+    return total_frames;
+}
+
+// Mede o tempo médio de um passo fixo da física com num_balls bolas
+static void MedirPasso(const PhysicsWorld& table, int num_balls)
+{
+    PhysicsWorld world = table;
+    const float width = 0.92f * world.parameters.width;  // Região da mesa onde as bolas são espalhadas (X)
+    const float depth = 0.96f * world.parameters.depth;  // (Z)
+
+    float y = world.balls.py[0];
+    float default_radius = world.balls.radius[0];
+    world.balls.clear();
+    world.resetContacts();
+
+    int cols = (int)std::ceil(std::sqrt(num_balls * width / depth));
+    int rows = (num_balls + cols - 1) / cols;
+    float spacing = std::min(width / cols, depth / rows);
+    float radius = std::min(default_radius, 0.4f * spacing);
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> random_speed(-1.0f, 1.0f);
+    for (int i = 0; i < num_balls; ++i)
+    {
+        float x = -width / 2.0f + ((i % cols) + 0.5f) * spacing;
+        float z = -depth / 2.0f + ((i / cols) + 0.5f) * spacing;
+        size_t b = world.balls.add(i % 16, glm::vec3(x, y, z), radius);
+        float speed_x = random_speed(rng);
+        world.balls.setVelocity(b, glm::vec3(speed_x, 0.0f, random_speed(rng)));
+    }
+
+    // Menos passos para muitas bolas, para que a medição não demore demais
+    int steps = num_balls >= 100000 ? 20 : (num_balls >= 1000 ? 600 : 1200);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int s = 0; s < steps; ++s)
+        world.SimularColisoes();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("Bench %d bolas (raio %.4f, broadphase %s, narrowphase %s, %u threads): %d passos, %.2f us/passo\n",
+           num_balls, radius, NomeDaBroadphase(world.broadphase), NomeDaNarrowphase(world.narrowphase),
+           world.threadPool ? world.threadPool->size() : 1u, steps, seconds / steps * 1e6);
+
+    if (num_balls >= 100000)
+        return;
+
+    // Para todas as bolas, espera elas dormirem e mede o passo com a mesa parada
+    for (size_t b = 0; b < world.balls.size(); ++b)
+    {
+        world.balls.setVelocity(b, glm::vec3(0.0f));
+        world.balls.setSpinVelocity(b, glm::vec2(0.0f));
+    }
+    for (int s = 0; s < 1000 && (s == 0 || world.awakeCount() > 0); ++s)
+        world.SimularColisoes();
+
+    start = std::chrono::steady_clock::now();
+    for (int s = 0; s < steps; ++s)
+        world.SimularColisoes();
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("Bench %d bolas paradas (broadphase %s): %zu acordadas, %.3f us/passo\n",
+           num_balls, NomeDaBroadphase(world.broadphase), world.awakeCount(), seconds / steps * 1e6);
+}
+
+// Espaçamento entre as bolas no teste de estresse, em raios (ocupa ~20% da mesa)
+const float STRESS_SPACING_RADII = 4.0f;
+// Limites de um teste de estresse: tempo de relógio e passos fixos
+const double STRESS_MAX_SECONDS = 5.0;
+const int    STRESS_MAX_STEPS = 1200;
+
+// Teste de estresse: num_balls bolas do raio da mesa, em movimento, numa
+// mesa retangular aumentada até elas caberem (MontarMesaRetangular). Mede
+// passos por segundo, testes bola-bola e bola-tabela por segundo e a
+// memória por bola, para achar onde SimularColisoes deixa de escalar.
+static void TestarEstresse(const PhysicsWorld& table, int num_balls)
+{
+    PhysicsWorld world = table;
+    const float radius = world.parameters.ball_radius;
+    const float spacing = STRESS_SPACING_RADII * radius;
+    const int cols = std::max(1, (int)std::ceil(std::sqrt(num_balls / 2.0f)));
+    const int rows = (num_balls + cols - 1) / cols;
+    const float width = cols * spacing + 2.0f * radius;
+    const float depth = std::max(rows * spacing + 2.0f * radius, 0.5f * width);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    MontarMesaRetangular(world, width, depth);
+    double field_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> random_speed(-2.0f, 2.0f);
+    world.balls.reserve(num_balls);
+    for (int i = 0; i < num_balls; ++i)
+    {
+        float x = -0.5f * width + radius + ((i % cols) + 0.5f) * spacing;
+        float z = -0.5f * depth + radius + ((i / cols) + 0.5f) * spacing;
+        size_t b = world.balls.add(i % 16, glm::vec3(x, world.parameters.ball_y, z), radius);
+        float speed_x = random_speed(rng);
+        world.balls.setVelocity(b, glm::vec3(speed_x, 0.0f, random_speed(rng)));
+    }
+    double setup_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Para quando todas as bolas dormem: passos sem subpasso quase não custam
+    // nada e inflariam os passos por segundo
+    int steps = 0;
+    long long substeps = 0;
+    double seconds = 0.0;
+    bool stopped = false;
+    start = std::chrono::steady_clock::now();
+    while (steps < STRESS_MAX_STEPS && seconds < STRESS_MAX_SECONDS)
+    {
+        int step_substeps = world.SimularColisoes();
+        if (step_substeps == 0)
+        {
+            stopped = true;
+            break;
+        }
+        substeps += step_substeps;
+        ++steps;
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    int pocketed = 0;
+    for (size_t b = 0; b < world.balls.size(); ++b)
+        if (!world.balls.active[b]) ++pocketed;
+
+    const double memory = (double)world.memoryUsage();
+    const double ball_memory = (double)world.balls.memoryUsage();
+    const double field_memory = (double)world.segmentFieldMemoryUsage();
+    printf("Estresse %d bolas (raio %.4f, mesa %.2f x %.2f m, broadphase %s, narrowphase %s, %u threads)\n",
+           num_balls, radius, width, depth, NomeDaBroadphase(world.broadphase), NomeDaNarrowphase(world.narrowphase),
+           world.threadPool ? world.threadPool->size() : 1u);
+    printf("  Montagem: %.1f ms (campo de distância %.1f ms)\n", setup_seconds * 1000.0, field_seconds * 1000.0);
+    printf("  %d passos, %lld subpassos em %.3f s%s: %.1f passos/s, %.1f subpassos/s, %.3f ms/subpasso\n",
+           steps, substeps, seconds, stopped ? " (até as bolas pararem)" : "",
+           steps / seconds, substeps / seconds, seconds / std::max(substeps, 1LL) * 1000.0);
+    printf("  Testes bola-bola: %.3g/s (%.1f por bola por subpasso); bola-tabela: %.3g/s\n",
+           world.totalPairTests() / seconds,
+           world.totalPairTests() / ((double)num_balls * std::max(substeps, 1LL)),
+           world.totalSegmentTests() / seconds);
+    printf("  Memória: %.2f MB, %.1f bytes por bola (bolas %.1f, campo das tabelas %.1f, buffers %.1f); "
+           "BallRenderInfo do jogo: mais %zu bytes por bola\n",
+           memory / (1024.0 * 1024.0), memory / num_balls, ball_memory / num_balls,
+           field_memory / num_balls, (memory - ball_memory - field_memory) / num_balls, sizeof(BallRenderInfo));
+    printf("  %d encaçapadas, %zu acordadas no último passo\n", pocketed, world.awakeCount());
+}
+
+// Passos fixos depois da tacada de abertura em que o estado é conferido
+// (0,25 s: as bolas ainda estão todas em movimento)
+const int CHECK_STATE_STEPS = 30;
+
+// Confere o TableState numa mesa em movimento: salva o estado logo depois da
+// tacada de abertura, restaura e salva de novo. Os dois estados precisam ter
+// os mesmos bytes e o mesmo hash, e restaurar não pode mudar a memória do
+// mundo. Retorna false (e mostra o erro) se alguma conferência falhar.
+static bool TestarEstado(const PhysicsWorld& table)
+{
+    PhysicsWorld world = table;
+    world.balls.setVelocity(0, VelocidadeDaTacada(glm::pi<float>(), 100.0f));
+    for (int s = 0; s < CHECK_STATE_STEPS; ++s)
+        world.SimularColisoes();
+
+    size_t moving = 0;
+    for (size_t i = 0; i < world.balls.size(); ++i)
+        if (world.balls.active[i] && glm::length(glm::vec2(world.balls.vx[i], world.balls.vz[i])) >= VELOCITY_STOP_THRESHOLD)
+            ++moving;
+
+    TableState saved, restored;
+    if (!world.saveState(saved))
+    {
+        fprintf(stderr, "ERROR: The table has more than %d balls.\n", TABLE_STATE_MAX_BALLS);
+        return false;
+    }
+    const size_t memory = world.memoryUsage();
+    if (!world.restoreState(saved) || !world.saveState(restored))
+    {
+        fprintf(stderr, "ERROR: Could not restore the saved state.\n");
+        return false;
+    }
+
+    printf("Estado: %zu bytes, %u bolas (%zu em movimento), hash %016llx\n",
+           sizeof(TableState), (unsigned)saved.count, moving, (unsigned long long)saved.hash());
+    if (saved != restored || saved.hash() != restored.hash())
+    {
+        fprintf(stderr, "ERROR: Saving a restored state gave different bytes.\n");
+        return false;
+    }
+    if (world.memoryUsage() != memory)
+    {
+        fprintf(stderr, "ERROR: Restoring the state changed the world memory (%zu -> %zu bytes).\n",
+                memory, world.memoryUsage());
+        return false;
+    }
+    printf("  salvar -> restaurar -> salvar: mesmos bytes, memória do mundo igual (%zu bytes)\n", memory);
+    return true;
+}
+
+// Número de tacadas mostradas por --evaluate e --candidates
+const size_t EVALUATE_TOP_SHOTS = 10;
+
+static void ImprimirMelhores(const std::vector<ShotOutcome>& outcomes);
+
+// Avalia uma grade de tacadas a partir da mesa inicial e mostra as melhores
+static void AvaliarMesa(const PhysicsWorld& table, int angle_steps, int power_steps, int noise_samples, ThreadPool& pool)
+{
+    std::vector<ShotParameters> shots = GradeDeTacadas(0.0f, 2.0f * glm::pi<float>(), angle_steps, 25.0f, 100.0f, power_steps);
+    ShotEvaluation settings;
+    settings.noise_samples = noise_samples;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<ShotOutcome> outcomes = AvaliarTacadas(table, shots, settings, &pool);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const size_t simulations = shots.size() * noise_samples;
+    printf("Avaliação: %zu tacadas x %d simulações em %.3f s, %.0f simulações/s (%u threads)\n",
+           shots.size(), noise_samples, seconds, simulations / seconds, pool.size());
+    ImprimirMelhores(outcomes);
+}
+
+// Gera as tacadas candidatas pela geometria, simula as max_candidates
+// melhores e mostra o resultado
+static void AvaliarCandidatasDaMesa(const PhysicsWorld& table, int max_candidates, ThreadPool& pool)
+{
+    CandidateSettings candidate_settings;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<ShotCandidate> candidates = GerarCandidatas(table, candidate_settings);
+    double generate_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int count[3] = {0, 0, 0};
+    for (size_t c = 0; c < candidates.size(); ++c)
+        count[candidates[c].kind]++;
+    printf("Candidatas: %zu (%d diretas, %d de tabela, %d combinações) em %.3f ms\n",
+           candidates.size(), count[SHOT_DIRECT], count[SHOT_BANK], count[SHOT_COMBINATION], generate_seconds * 1000.0);
+    for (size_t c = 0; c < candidates.size() && c < (size_t)max_candidates; ++c)
+    {
+        const ShotCandidate& candidate = candidates[c];
+        printf("  %2zu. %-11s bola %2d -> bola %2d -> caçapa %d: angulo %6.2f forca %5.1f%%, corte %4.1f graus, prior %.3f\n",
+               c + 1, NomeDoTipoDeTacada(candidate.kind), table.balls.number[candidate.ball],
+               table.balls.number[candidate.target], candidate.pocket, glm::degrees(candidate.shot.angle),
+               candidate.shot.power, glm::degrees(candidate.cut_angle), candidate.prior);
+    }
+
+    ShotEvaluation settings;
+    start = std::chrono::steady_clock::now();
+    std::vector<ShotOutcome> outcomes = AvaliarCandidatas(table, max_candidates, candidate_settings, settings, &pool);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("Avaliação das %zu melhores x %d simulações em %.3f s (%u threads)\n",
+           outcomes.size(), settings.noise_samples, seconds, pool.size());
+    ImprimirMelhores(outcomes);
+}
+
+// Mostra as EVALUATE_TOP_SHOTS melhores tacadas avaliadas
+static void ImprimirMelhores(const std::vector<ShotOutcome>& outcomes)
+{
+    for (size_t k = 0; k < outcomes.size() && k < EVALUATE_TOP_SHOTS; ++k)
+    {
+        const ShotOutcome& outcome = outcomes[k];
+        printf("  %2zu. angulo %6.2f forca %5.1f%%: score %.2f, %.2f encaçapadas, %.0f%% branca encaçapada, "
+               "branca em (%.3f, %.3f), %.2f s\n",
+               k + 1, glm::degrees(outcome.shot.angle), outcome.shot.power, outcome.score, outcome.potted,
+               outcome.scratch_rate * 100.0f, outcome.cue_position.x, outcome.cue_position.y, outcome.sim_time);
+    }
+}
+
+static void ImprimirUso(const char* program)
+{
+    fprintf(stderr,
+            "Uso: %s [--table arquivo] [--layout arquivo] [--shots arquivo] [--shot angulo forca]... [--max-time segundos] [--tables N] [--bench N]... [--events] [--narrowphase scalar|sse2|avx2] [--broadphase grid|sap] [--substeps N] [--realtime] [--stress N]... [--threads N] [--evaluate angulos forcas amostras] [--candidates K] [--check-state]\n",
+            program);
+}
+
+int main(int argc, char* argv[])
+{
+    const char* table_file = NULL;
+    const char* layout_file = NULL;
+    std::vector<Tacada> shots;
+    float max_time_per_shot = 60.0f;
+    int num_tables = 1;
+    std::vector<int> bench_sizes;
+    std::vector<int> stress_sizes;
+    bool use_events = false;
+    const char* narrowphase_name = NULL;
+    const char* broadphase_name = NULL;
+    int fixed_substeps = 0;
+    bool use_realtime = false;
+    int pool_threads = 0; // 0: --threads não foi dado
+    int evaluate_angles = 0;
+    int evaluate_powers = 0;
+    int evaluate_samples = 0;
+    int max_candidates = 0;
+    bool check_state = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--table") == 0 && i + 1 < argc)
+        {
+            table_file = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--layout") == 0 && i + 1 < argc)
+        {
+            layout_file = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--shots") == 0 && i + 1 < argc)
+        {
+            if (!CarregarTacadas(argv[++i], shots))
+                return EXIT_FAILURE;
+        }
+        else if (std::strcmp(argv[i], "--shot") == 0 && i + 2 < argc)
+        {
+            Tacada shot;
+            shot.angle_degrees = (float)std::atof(argv[++i]);
+            shot.power_percentage = (float)std::atof(argv[++i]);
+            shots.push_back(shot);
+        }
+        else if (std::strcmp(argv[i], "--max-time") == 0 && i + 1 < argc)
+        {
+            max_time_per_shot = (float)std::atof(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--tables") == 0 && i + 1 < argc)
+        {
+            num_tables = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--events") == 0)
+        {
+            use_events = true;
+        }
+        else if (std::strcmp(argv[i], "--realtime") == 0)
+        {
+            use_realtime = true;
+        }
+        else if (std::strcmp(argv[i], "--narrowphase") == 0 && i + 1 < argc)
+        {
+            narrowphase_name = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--broadphase") == 0 && i + 1 < argc)
+        {
+            broadphase_name = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--substeps") == 0 && i + 1 < argc)
+        {
+            fixed_substeps = std::max(0, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--stress") == 0 && i + 1 < argc)
+        {
+            stress_sizes.push_back(std::max(1, std::atoi(argv[++i])));
+        }
+        else if (std::strcmp(argv[i], "--bench") == 0 && i + 1 < argc)
+        {
+            bench_sizes.push_back(std::max(1, std::atoi(argv[++i])));
+        }
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            pool_threads = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--evaluate") == 0 && i + 3 < argc)
+        {
+            evaluate_angles = std::max(1, std::atoi(argv[++i]));
+            evaluate_powers = std::max(1, std::atoi(argv[++i]));
+            evaluate_samples = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--candidates") == 0 && i + 1 < argc)
+        {
+            max_candidates = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--check-state") == 0)
+        {
+            check_state = true;
+        }
+        else
+        {
+            ImprimirUso(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    PhysicsWorld table;
+    MontarMesaPadrao(table);
+    table.fixedSubsteps = fixed_substeps;
+    table.integrateOrientation = false; // Sem desenho, o rolamento não importa
+    if (narrowphase_name)
+    {
+        table.narrowphase = NarrowphasePorNome(narrowphase_name);
+        if (!table.narrowphase)
+        {
+            fprintf(stderr, "ERROR: Narrowphase \"%s\" is unknown or not supported by this CPU.\n", narrowphase_name);
+            return EXIT_FAILURE;
+        }
+    }
+    if (broadphase_name && !BroadphasePorNome(broadphase_name, table.broadphase))
+    {
+        fprintf(stderr, "ERROR: Broadphase \"%s\" is unknown (use grid or sap).\n", broadphase_name);
+        return EXIT_FAILURE;
+    }
+    if (table_file && !CarregarMesa(table_file, table))
+        return EXIT_FAILURE;
+    if (layout_file && !CarregarLayoutMesa(layout_file, table))
+        return EXIT_FAILURE;
+    if (table.balls.empty() || table.balls.number[0] != 0)
+    {
+        fprintf(stderr, "ERROR: The first ball of the layout must be the cue ball (bola 0).\n");
+        return EXIT_FAILURE;
+    }
+    // Mesas simuladas ao mesmo tempo não podem dividir o mesmo pool
+    if (pool_threads > 1 && num_tables > 1)
+    {
+        fprintf(stderr, "ERROR: --threads cannot be combined with --tables.\n");
+        return EXIT_FAILURE;
+    }
+    // A avaliação divide as simulações entre as threads; o resto divide o
+    // passo fixo de uma mesa só
+    const bool evaluate = evaluate_angles > 0 || max_candidates > 0;
+    if (pool_threads == 0)
+        pool_threads = evaluate ? static_cast<int>(std::max(1u, std::thread::hardware_concurrency())) : 1;
+    ThreadPool pool(static_cast<unsigned>(pool_threads));
+    if (pool_threads > 1 && !evaluate)
+        table.threadPool = &pool;
+
+    if (check_state)
+        return TestarEstado(table) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    if (evaluate)
+    {
+        if (max_candidates > 0)
+            AvaliarCandidatasDaMesa(table, max_candidates, pool);
+        else
+            AvaliarMesa(table, evaluate_angles, evaluate_powers, evaluate_samples, pool);
+        return EXIT_SUCCESS;
+    }
+
+    if (!stress_sizes.empty())
+    {
+        for (int num_balls : stress_sizes)
+            TestarEstresse(table, num_balls);
+        return EXIT_SUCCESS;
+    }
+
+    if (!bench_sizes.empty())
+    {
+        for (int num_balls : bench_sizes)
+        {
+            if (broadphase_name)
+            {
+                MedirPasso(table, num_balls);
+                continue;
+            }
+            // Compara as duas broadphases com as mesmas bolas
+            PhysicsWorld grid = table;
+            grid.broadphase = BROADPHASE_GRID;
+            MedirPasso(grid, num_balls);
+            PhysicsWorld sap = table;
+            sap.broadphase = BROADPHASE_SWEEP_AND_PRUNE;
+            MedirPasso(sap, num_balls);
+        }
+        return EXIT_SUCCESS;
+    }
+
+    if (shots.empty())
+    {
+        // Sem tacadas na linha de comando: uma tacada de abertura em força máxima
+        Tacada shot;
+        shot.angle_degrees = 180.0f;
+        shot.power_percentage = 100.0f;
+        shots.push_back(shot);
+    }
+
+    const int max_steps_per_shot = (int)(max_time_per_shot / FIXED_PHYSICS_DELTA_TIME);
+
+    if (num_tables > 1)
+    {
+        // Cada mesa é uma cópia independente do layout inicial
+        std::vector<PhysicsWorld> tables(num_tables, table);
+        std::vector<long long> steps_per_table(num_tables, 0);
+
+        unsigned int num_threads = std::max(1u, std::thread::hardware_concurrency());
+        num_threads = std::min<unsigned int>(num_threads, num_tables);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (unsigned int t = 0; t < num_threads; ++t)
+        {
+            threads.push_back(std::thread([&, t]() {
+                for (int m = (int)t; m < num_tables; m += num_threads)
+                    steps_per_table[m] = use_events
+                        ? SimularTacadasPorEventos(tables[m], shots, max_time_per_shot, false)
+                        : SimularTacadas(tables[m], shots, max_steps_per_shot, false);
+            }));
+        }
+        for (auto& thread : threads)
+            thread.join();
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+        long long total_steps = 0;
+        for (long long steps : steps_per_table)
+            total_steps += steps;
+        double seconds = std::chrono::duration<double>(end - start).count();
+        printf("%d mesas em %u threads: %lld %s em %.3f ms, %.0f %s/s\n",
+               num_tables, num_threads, total_steps, use_events ? "eventos" : "passos", seconds * 1000.0,
+               seconds > 0.0 ? total_steps / seconds : 0.0, use_events ? "eventos" : "passos");
+        return EXIT_SUCCESS;
+    }
+
+    if (use_realtime)
+    {
+        long long frames = SimularTacadasEmTempoReal(table, shots, max_time_per_shot, true);
+        printf("Total: %lld quadros, %.3f s simulados, %.3f s descartados\n",
+               frames, table.simTime, table.droppedTime());
+        for (size_t i = 0; i < table.balls.size(); ++i)
+        {
+            if (table.balls.active[i])
+                printf("Bola %2d: (%.4f, %.4f)\n", table.balls.number[i], table.balls.px[i], table.balls.pz[i]);
+            else
+                printf("Bola %2d: encacapada\n", table.balls.number[i]);
+        }
+        return EXIT_SUCCESS;
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    long long total_steps = use_events
+        ? SimularTacadasPorEventos(table, shots, max_time_per_shot, true)
+        : SimularTacadas(table, shots, max_steps_per_shot, true);
+    double total_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("Total: %lld %s em %.3f ms, %.0f %s/s\n",
+           total_steps, use_events ? "eventos" : "passos", total_seconds * 1000.0,
+           total_seconds > 0.0 ? total_steps / total_seconds : 0.0, use_events ? "eventos" : "passos");
+
+    for (size_t i = 0; i < table.balls.size(); ++i)
+    {
+        if (table.balls.active[i])
+            printf("Bola %2d: (%.4f, %.4f)\n", table.balls.number[i], table.balls.px[i], table.balls.pz[i]);
+        else
+            printf("Bola %2d: encacapada\n", table.balls.number[i]);
+    }
+
+    return EXIT_SUCCESS;
+}